@@ -0,0 +1,4 @@
+#pragma once
+
+void bench_sort();
+void bench_mesh_ray();
@@ -0,0 +1,185 @@
+#include "../../StereoKitC/stereokit.h"
+#include "../../StereoKitC/math.h"
+#include "../../StereoKitC/asset_types/mesh.h"
+#include "../../StereoKitC/asset_types/mesh_bvh.h"
+#include "../../StereoKitC/systems/memory_track.h"
+using namespace sk;
+
+#include "bench.h"
+
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+
+#include <chrono>
+using namespace std::chrono;
+
+///////////////////////////////////////////
+
+// Same as mesh_ray_intersect_batch uses
+const int32_t bench_ray_job_size = 32;
+
+///////////////////////////////////////////
+
+// A UV sphere, which gives a nice spread of triangle sizes for the BVH
+void bench_sphere(int32_t stacks, vert_t **out_verts, int32_t *out_vert_count, vind_t **out_inds, int32_t *out_ind_count) {
+	int32_t slices     = stacks * 2;
+	int32_t vert_count = (stacks + 1) * (slices + 1);
+	int32_t ind_count  = stacks * slices * 6;
+	vert_t *verts      = (vert_t*)malloc(sizeof(vert_t) * vert_count);
+	vind_t *inds       = (vind_t*)malloc(sizeof(vind_t) * ind_count);
+
+	for (int32_t y = 0; y <= stacks; y++) {
+		float pitch = (y / (float)stacks) * 3.14159265f;
+		for (int32_t x = 0; x <= slices; x++) {
+			float yaw = (x / (float)slices) * 2 * 3.14159265f;
+			vec3  dir = { sinf(pitch) * cosf(yaw), cosf(pitch), sinf(pitch) * sinf(yaw) };
+			verts[y * (slices + 1) + x] = { dir * 0.5f, dir, { x / (float)slices, y / (float)stacks }, {255,255,255,255} };
+		}
+	}
+
+	int32_t ind = 0;
+	for (int32_t y = 0; y < stacks; y++) {
+		for (int32_t x = 0; x < slices; x++) {
+			vind_t a = (vind_t)( y    * (slices + 1) + x);
+			vind_t b = (vind_t)((y+1) * (slices + 1) + x);
+			inds[ind++] = a; inds[ind++] = b;     inds[ind++] = a + 1;
+			inds[ind++] = b; inds[ind++] = b + 1; inds[ind++] = a + 1;
+		}
+	}
+
+	*out_verts      = verts;
+	*out_vert_count = vert_count;
+	*out_inds       = inds;
+	*out_ind_count  = ind_count;
+}
+
+///////////////////////////////////////////
+
+// Tests every triangle, which is what mesh_ray_intersect did before the
+// BVH. The plane and point in triangle tests are deliberately different
+// from the BVH's, so the two check each other.
+bool32_t bench_ray_linear(const mesh_collision_t &collision, ray_t ray, vec3 *out_pt) {
+	vec3  pt           = {};
+	float nearest_dist = FLT_MAX;
+	for (int32_t i = 0; i < collision.tri_count * 3; i += 3) {
+		vec3 p0 = collision.verts[collision.inds[i  ]].pos;
+		vec3 p1 = collision.verts[collision.inds[i+1]].pos;
+		vec3 p2 = collision.verts[collision.inds[i+2]].pos;
+
+		vec3    normal = vec3_normalize( vec3_cross(p1 - p0, p1 - p2) );
+		plane_t plane  = { normal, -vec3_dot(p1, normal) };
+		if (!plane_ray_intersect(plane, ray, &pt))
+			continue;
+
+		// point in triangle, implementation based on:
+		// https://blackpawn.com/texts/pointinpoly/default.html
+		vec3  v0    = p1 - p0;
+		vec3  v1    = p2 - p0;
+		vec3  v2    = pt - p0;
+		float dot00 = vec3_dot(v0, v0);
+		float dot01 = vec3_dot(v0, v1);
+		float dot02 = vec3_dot(v0, v2);
+		float dot11 = vec3_dot(v1, v1);
+		float dot12 = vec3_dot(v1, v2);
+
+		float inv_denom = 1.0f / (dot00 * dot11 - dot01 * dot01);
+		float u = (dot11 * dot02 - dot01 * dot12) * inv_denom;
+		float v = (dot00 * dot12 - dot01 * dot02) * inv_denom;
+		if ((u >= 0) && (v >= 0) && (u + v < 1)) {
+			float dist = vec3_magnitude_sq(pt - ray.pos);
+			if (dist < nearest_dist) {
+				nearest_dist = dist;
+				*out_pt      = pt;
+			}
+		}
+	}
+	return nearest_dist != FLT_MAX;
+}
+
+///////////////////////////////////////////
+
+void bench_mesh_ray() {
+	const int32_t stacks[]  = { 8, 32, 112 };
+	const int32_t ray_count = 2000;
+
+	ray_t    *rays       = (ray_t   *)malloc(sizeof(ray_t)    * ray_count);
+	vec3     *batch_pts  = (vec3    *)malloc(sizeof(vec3)     * ray_count);
+	bool32_t *batch_hits = (bool32_t*)malloc(sizeof(bool32_t) * ray_count);
+
+	log_info("Mesh ray benchmark:");
+	for (size_t s = 0; s < _countof(stacks); s++) {
+		vert_t *verts;
+		vind_t *inds;
+		int32_t vert_count, ind_count;
+		bench_sphere(stacks[s], &verts, &vert_count, &inds, &ind_count);
+
+		mesh_collision_t collision = {};
+		collision.verts     = verts;
+		collision.inds      = inds;
+		collision.tri_count = ind_count / 3;
+		mesh_bvh_build(collision);
+		size_t collision_bytes =
+			sizeof(uint32_t)        * collision.tri_count +
+			sizeof(mesh_bvh_node_t) * collision.bvh.node_count;
+
+		// Rays start outside the sphere and aim near its center, so most
+		// of them hit, but a few miss.
+		uint32_t seed = 1;
+		for (int32_t i = 0; i < ray_count; i++) {
+			float r[6];
+			for (int32_t c = 0; c < 6; c++) {
+				seed = seed * 1664525 + 1013904223;
+				r[c] = (seed >> 8) / (float)(1 << 24) * 2 - 1;
+			}
+			vec3 from = vec3_normalize({ r[0], r[1], r[2] + 0.01f }) * 2;
+			vec3 at   = vec3{ r[3], r[4], r[5] } * 0.6f;
+			rays[i] = { from, at - from };
+		}
+
+		int32_t hits       = 0;
+		int32_t mismatches = 0;
+		int64_t ns_linear  = 0;
+		int64_t ns_bvh     = 0;
+		for (int32_t i = 0; i < ray_count; i++) {
+			vec3 pt_linear = {}, pt_bvh = {};
+			time_point<high_resolution_clock> start = high_resolution_clock::now();
+			bool32_t hit_linear = bench_ray_linear(collision, rays[i], &pt_linear);
+			ns_linear += duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+
+			start = high_resolution_clock::now();
+			bool32_t hit_bvh = ray_intersect_x1(collision, rays[i], &pt_bvh);
+			ns_bvh += duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+
+			if (hit_bvh) hits += 1;
+			if ((hit_linear != 0) != (hit_bvh != 0) || (hit_bvh && vec3_magnitude_sq(pt_linear - pt_bvh) > 1e-6f))
+				mismatches += 1;
+		}
+
+		// The same rays again as one batch, so packets and jobs kick in
+		time_point<high_resolution_clock> start = high_resolution_clock::now();
+		ray_batch_run(collision, rays, ray_count, batch_pts, batch_hits, bench_ray_job_size);
+		int64_t ns_batch = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+		for (int32_t i = 0; i < ray_count; i++) {
+			vec3     pt  = {};
+			bool32_t hit = ray_intersect_x1(collision, rays[i], &pt);
+			if ((hit != 0) != (batch_hits[i] != 0) || (hit && vec3_magnitude_sq(pt - batch_pts[i]) > 1e-6f))
+				mismatches += 1;
+		}
+
+		double rays_linear = ray_count / (ns_linear / 1000000000.0);
+		double rays_bvh    = ray_count / (ns_bvh    / 1000000000.0);
+		double rays_batch  = ray_count / (ns_batch  / 1000000000.0);
+		log_infof("%7d tris: linear %10.0f rays/s, bvh %10.0f rays/s (%.1fx), batch %10.0f rays/s (%.1fx), %d/%d hits, %d mismatches, %.1fKB collision data",
+			collision.tri_count, rays_linear, rays_bvh, rays_bvh / rays_linear, rays_batch, rays_batch / rays_linear, hits, ray_count, mismatches, collision_bytes / 1024.0);
+
+		mesh_bvh_free(collision.bvh);
+		sk_free(collision.tris);
+		free(verts);
+		free(inds);
+	}
+
+	free(rays);
+	free(batch_pts);
+	free(batch_hits);
+}
@@ -0,0 +1,133 @@
+#include "../../StereoKitC/systems/render_sort.h"
+using namespace sk;
+
+#include "bench.h"
+
+#include <algorithm>
+#include <string.h>
+#include <assert.h>
+
+#include <chrono>
+using namespace std::chrono;
+
+///////////////////////////////////////////
+
+const size_t   radix_bits   = 8;
+const size_t   radix_size   = (size_t)1 << radix_bits;
+const size_t   radix_levels = (63 / radix_bits) + 1;
+const uint64_t radix_mask   = radix_size - 1;
+
+///////////////////////////////////////////
+
+// The sort the renderer used before radix_sort_keys, which moves the full
+// render items around on every pass. Kept here as the baseline.
+void radix_sort7(render_item_t *a, size_t count) {
+	render_item_t *queue_area = (render_item_t*)malloc(sizeof(render_item_t) * count);
+
+	size_t freqs[radix_levels][radix_size] = {};
+	for (size_t i = 0; i < count; i++) {
+		uint64_t value = a[i].sort_id;
+		for (size_t pass = 0; pass < radix_levels; pass++) {
+			freqs[pass][value & radix_mask]++;
+			value >>= radix_bits;
+		}
+	}
+
+	render_item_t *from = a, *to = queue_area;
+	for (size_t pass = 0; pass < radix_levels; pass++) {
+		// A pass where everything lands in one bucket is just a copy
+		bool trivial = false;
+		for (size_t i = 0; i < radix_size; i++) {
+			if (freqs[pass][i] != 0) { trivial = freqs[pass][i] == count; break; }
+		}
+		if (trivial) continue;
+
+		uint64_t shift = pass * radix_bits;
+		render_item_t *queue_ptrs[radix_size], *next = to;
+		for (size_t i = 0; i < radix_size; i++) {
+			queue_ptrs[i] = next;
+			next += freqs[pass][i];
+		}
+		for (size_t i = 0; i < count; i++) {
+			render_item_t value = from[i];
+			*queue_ptrs[(value.sort_id >> shift) & radix_mask]++ = value;
+		}
+		std::swap(from, to);
+	}
+
+	if (from != a)
+		memcpy(a, from, sizeof(render_item_t) * count);
+	free(queue_area);
+}
+
+///////////////////////////////////////////
+
+void bench_sort() {
+	const int32_t sizes[]    = { 1000, 10000, 100000 };
+	const int32_t iterations = 20;
+
+	render_sort_scratch_t  scratch = {};
+	array_t<render_item_t> source  = {};
+	array_t<render_item_t> queue   = {};
+	array_t<render_item_t> sorted  = {};
+
+	log_info("Render sort benchmark:");
+	for (size_t s = 0; s < _countof(sizes); s++) {
+		int32_t count = sizes[s];
+
+		// Build a queue that looks like a real scene: a handful of queues,
+		// materials and meshes, so some radix passes will be trivial.
+		uint32_t seed = 1;
+		source.clear();
+		for (int32_t i = 0; i < count; i++) {
+			seed = seed * 1664525 + 1013904223;
+			render_item_t item = {};
+			item.sort_id = 
+				((uint64_t)((seed >> 28) % 3 + 1) * 1000 << 32) |
+				((uint64_t)((seed >> 16) % 64) << 16) |
+				((uint64_t)( seed        % 256));
+			source.add(item);
+		}
+		queue .resize(count); queue .count = count;
+		sorted.resize(count); sorted.count = count;
+
+		int64_t ns_old = 0;
+		int64_t ns_new = 0;
+		for (int32_t i = 0; i < iterations; i++) {
+			memcpy(sorted.data, source.data, sizeof(render_item_t) * count);
+			time_point<high_resolution_clock> start = high_resolution_clock::now();
+			radix_sort7(sorted.data, count);
+			ns_old += duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+
+			start = high_resolution_clock::now();
+			if (scratch.keys.capacity < count)
+				scratch.keys.resize(count);
+			scratch.keys.count = count;
+			for (int32_t k = 0; k < count; k++) {
+				scratch.keys[k].sort_id = source[k].sort_id;
+				scratch.keys[k].index   = (uint32_t)k;
+			}
+			radix_sort_keys(scratch);
+			for (int32_t k = 0; k < count; k++) {
+				queue[k] = source[scratch.keys[k].index];
+			}
+			ns_new += duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+		}
+
+		// Both are stable sorts, so they should agree item for item
+		int32_t mismatches = 0;
+		for (int32_t k = 0; k < count; k++) {
+			if (queue[k].sort_id != sorted[k].sort_id || (k > 0 && queue[k-1].sort_id > queue[k].sort_id))
+				mismatches += 1;
+		}
+
+		double ms_old = (ns_old / (double)iterations) / 1000000.0;
+		double ms_new = (ns_new / (double)iterations) / 1000000.0;
+		log_infof("%7d items: radix_sort7 %7.3fms, radix_sort_keys %7.3fms (%.2fx), %d mismatches", count, ms_old, ms_new, ms_old / ms_new, mismatches);
+	}
+
+	source.free();
+	queue .free();
+	sorted.free();
+	scratch.keys.free();
+}
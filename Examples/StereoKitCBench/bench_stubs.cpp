@@ -0,0 +1,46 @@
+#include "../../StereoKitC/stereokit.h"
+#include "../../StereoKitC/systems/memory_track.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+// Stand-ins for the parts of the engine the benchmarked code calls into,
+// without pulling in the rest of StereoKitC. Memory tracking and the
+// profiler are compiled out with SK_NO_MEMORY_TRACKING and SK_NO_PROFILER.
+
+namespace sk {
+
+///////////////////////////////////////////
+
+void *sk_malloc (size_t size)               { return malloc(size); }
+void *sk_calloc (size_t count, size_t size) { return calloc(count, size); }
+void *sk_realloc(void *memory, size_t size) { return realloc(memory, size); }
+void  sk_free   (void *memory)              { free(memory); }
+
+///////////////////////////////////////////
+
+void bench_log(const char *text, va_list args) {
+	vprintf(text, args);
+	printf("\n");
+}
+
+///////////////////////////////////////////
+
+void log_write (log_ level, const char *text)      { printf("%s\n", text); }
+void log_writef(log_ level, const char *text, ...) { va_list args; va_start(args, text); bench_log(text, args); va_end(args); }
+void log_info  (const char *text)                  { log_write(log_inform,  text); }
+void log_warn  (const char *text)                  { log_write(log_warning, text); }
+void log_err   (const char *text)                  { log_write(log_error,   text); }
+void log_infof (const char *text, ...)             { va_list args; va_start(args, text); bench_log(text, args); va_end(args); }
+void log_warnf (const char *text, ...)             { va_list args; va_start(args, text); bench_log(text, args); va_end(args); }
+void log_errf  (const char *text, ...)             { va_list args; va_start(args, text); bench_log(text, args); va_end(args); }
+
+///////////////////////////////////////////
+
+// math.cpp's screen ray helpers want a display and a head
+system_info_t sk_system_info     ()                        { return {}; }
+const pose_t &input_head         ()                        { static pose_t head = { {0,0,0}, {0,0,0,1} }; return head; }
+vec3          render_unproject_pt(vec3 normalized_screen_pt) { return normalized_screen_pt; }
+
+} // namespace sk
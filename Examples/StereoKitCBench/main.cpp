@@ -0,0 +1,19 @@
+#include "../../StereoKitC/stereokit.h"
+#include "../../StereoKitC/systems/job.h"
+using namespace sk;
+
+#include "bench.h"
+
+// Benchmarks for engine internals that the public API can't reach. The
+// engine sources they measure get compiled straight into this executable,
+// so none of this ends up in StereoKitC itself.
+
+int main() {
+	job_init();
+
+	bench_sort();
+	bench_mesh_ray();
+
+	job_shutdown();
+	return 0;
+}
@@ -0,0 +1,71 @@
+﻿using StereoKit;
+using System.IO;
+
+class TestDiagnostics : ITest
+{
+    bool MemoryTracksMeshes()
+    {
+        MemoryStats before = Memory.GetStats(MemoryTag.Mesh);
+        Mesh mesh = Mesh.GenerateSphere(1, 16);
+        MemoryStats after  = Memory.GetStats(MemoryTag.Mesh);
+        return after.liveBytes > before.liveBytes
+            && after.totalCount > before.totalCount
+            && after.peakBytes >= after.liveBytes
+            && mesh != null;
+    }
+
+    bool MemoryTagNames()
+    {
+        return Memory.TagName(MemoryTag.General) == "General"
+            && Memory.TagName(MemoryTag.Mesh)    == "Mesh"
+            && Memory.TagName(MemoryTag.Log)     == "Log";
+    }
+
+    bool FrameStatsAreOrdered()
+    {
+        FrameStats stats = StereoKitApp.GetFrameStats();
+        FrameStats few   = StereoKitApp.GetFrameStats(1);
+        FrameStats none  = StereoKitApp.GetSystemFrameStats("Not a system");
+        return few.frameCount <= 1 && few.frameCount <= stats.frameCount
+            && stats.msP50 <= stats.msP95 && stats.msP95 <= stats.msP99 && stats.msP99 <= stats.msMax
+            && none.frameCount == 0;
+    }
+
+    bool FrameBudgetCounts()
+    {
+        // A budget nothing can meet sends every frame over
+        StereoKitApp.FrameBudget = 0.000001f;
+        bool over = StereoKitApp.GetFrameStats().overBudget == StereoKitApp.GetFrameStats().frameCount;
+        StereoKitApp.FrameBudget = 1000 / 60.0f;
+        return over && StereoKitApp.FramesOverBudget >= 0;
+    }
+
+    bool ProfilerCaptures()
+    {
+        Profiler.ZoneBegin("TestDiagnostics");
+        Profiler.ZoneEnd();
+        Profiler.Capture(2, Path.Combine(Path.GetTempPath(), "sk_test_trace.json"));
+        return Profiler.IsCapturing;
+    }
+
+    bool HeadlessNeedsHeadlessRuntime()
+    {
+        // Tests run with a window, and HeadlessRun should refuse to take
+        // over its frame loop.
+        return StereoKitApp.ActiveRuntime != Runtime.Headless
+            && !StereoKitApp.HeadlessRun(1, 1 / 60.0);
+    }
+
+    public void Initialize()
+    {
+        Tests.Test(MemoryTracksMeshes);
+        Tests.Test(MemoryTagNames);
+        Tests.Test(FrameStatsAreOrdered);
+        Tests.Test(FrameBudgetCounts);
+        Tests.Test(ProfilerCaptures);
+        Tests.Test(HeadlessNeedsHeadlessRuntime);
+    }
+
+    public void Shutdown(){}
+    public void Update(){}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+﻿using StereoKit;
+
+class TestRayBatch : ITest
+{
+    // A fan of rays around the origin, some of which miss everything
+    static Ray[] MakeRays(int count)
+    {
+        Ray[] rays = new Ray[count];
+        for (int i = 0; i < count; i++)
+        {
+            float x = (i % 10) / 4.5f - 1;
+            float y = (i / 10) / 4.5f - 1;
+            rays[i] = new Ray(new Vec3(x, y, 2), new Vec3(x * 0.1f, y * 0.1f, -1));
+        }
+        return rays;
+    }
+
+    static bool Same(bool hitA, Vec3 atA, bool hitB, Vec3 atB)
+        => hitA == hitB && (!hitA || Vec3.DistanceSq(atA, atB) < 0.00001f);
+
+    bool BatchMatchesSingle()
+    {
+        Ray[]  rays   = MakeRays(100);
+        Vec3[] at     = new Vec3[rays.Length];
+        bool[] hits   = new bool[rays.Length];
+        Plane  plane  = new Plane(Vec3.Zero, Vec3.Forward);
+        Sphere sphere = new Sphere(Vec3.Zero, 1);
+        Bounds bounds = new Bounds(Vec3.One);
+
+        int planeHits = plane.Intersect(rays, at, hits);
+        for (int i = 0; i < rays.Length; i++)
+            if (!Same(plane.Intersect(rays[i], out Vec3 pt), pt, hits[i], at[i])) return false;
+
+        int sphereHits = sphere.Intersect(rays, at, hits);
+        for (int i = 0; i < rays.Length; i++)
+            if (!Same(sphere.Intersect(rays[i], out Vec3 pt), pt, hits[i], at[i])) return false;
+
+        int boundsHits = bounds.Intersect(rays, at, hits);
+        for (int i = 0; i < rays.Length; i++)
+            if (!Same(bounds.Intersect(rays[i], out Vec3 pt), pt, hits[i], at[i])) return false;
+
+        return planeHits == rays.Length && sphereHits > 0 && sphereHits < rays.Length && boundsHits > 0 && boundsHits < rays.Length;
+    }
+
+    bool MeshBatchMatchesSingle()
+    {
+        Mesh   mesh = Mesh.GenerateSphere(1, 8);
+        Ray[]  rays = MakeRays(100);
+        Vec3[] at   = new Vec3[rays.Length];
+        bool[] hits = new bool[rays.Length];
+
+        int count = mesh.Intersect(rays, at, hits);
+        int check = 0;
+        for (int i = 0; i < rays.Length; i++)
+        {
+            bool hit = mesh.Intersect(rays[i], out Vec3 pt);
+            if (!Same(hit, pt, hits[i], at[i])) return false;
+            if (hit) check += 1;
+        }
+        return count == check && count > 0;
+    }
+
+    bool ModelIntersect()
+    {
+        Mesh  far   = Mesh.GenerateCube(Vec3.One);
+        Model model = Model.FromMesh(Mesh.GenerateCube(Vec3.One), Default.Material);
+        model.AddSubset(far, Default.Material, Matrix.T(0, 0, -2));
+
+        Ray ray = new Ray(new Vec3(0, 0, 2), new Vec3(0, 0, -1));
+        if (!model.Intersect(ray, out ModelHit hit)) return false;
+        if (hit.subset != 0 || Vec3.DistanceSq(hit.pt, new Vec3(0, 0, 0.5f)) > 0.00001f) return false;
+        if (hit.distance < 1.49f || hit.distance > 1.51f) return false;
+
+        // Moving the first subset out of the way should expose the second
+        model.SetTransform(0, Matrix.T(5, 0, 0));
+        if (!model.Intersect(ray, out hit)) return false;
+        if (hit.subset != 1 || Vec3.DistanceSq(hit.pt, new Vec3(0, 0, -1.5f)) > 0.00001f) return false;
+        Ray side = new Ray(new Vec3(1.2f, 0, 2), new Vec3(0, 0, -1));
+        if (model.Intersect(new Ray(new Vec3(0, 3, 2), new Vec3(0, 0, -1)), out hit)) return false;
+        if (model.Intersect(side, out hit)) return false;
+
+        // Growing the second subset's mesh after the model has been ray
+        // cast shouldn't leave the model's cached bounds behind.
+        Vertex[] verts = far.GetVerts();
+        for (int i = 0; i < verts.Length; i++)
+            verts[i].pos *= 3;
+        far.SetVerts(verts);
+        far.Bounds = new Bounds(Vec3.One * 3);
+        if (!model.Intersect(side, out hit)) return false;
+        return hit.subset == 1 && Vec3.DistanceSq(hit.pt, new Vec3(1.2f, 0, -0.5f)) < 0.00001f;
+    }
+
+    public void Initialize()
+    {
+        Tests.Test(BatchMatchesSingle);
+        Tests.Test(MeshBatchMatchesSingle);
+        Tests.Test(ModelIntersect);
+    }
+
+    public void Shutdown(){}
+    public void Update(){}
+}
\ No newline at end of file
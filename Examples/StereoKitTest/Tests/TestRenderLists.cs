@@ -0,0 +1,115 @@
+﻿using StereoKit;
+
+class TestRenderLists : ITest
+{
+    Tex            target;
+    RenderInstance instance;
+
+    bool ListExecutes()
+    {
+        target = new Tex(TexType.Rendertarget, TexFormat.Rgba32);
+        target.SetColors(64, 64, System.IntPtr.Zero);
+
+        Mesh       cube = Mesh.GenerateCube(Vec3.One * 0.5f);
+        RenderList list = new RenderList();
+        list.Push();
+        Renderer.Add(cube, Default.Material, Matrix.Identity);
+        Renderer.Add(cube, Default.Material, Matrix.T(0.25f, 0, 0));
+        Renderer.Add(cube, Default.Material, Matrix.T(100, 0, 0)); // Off screen
+        RenderList.Pop();
+
+        Matrix[] views       = { Matrix.Identity };
+        Matrix[] projections = { Matrix.TS(new Vec3(0, 0, 0.5f), new Vec3(1, 1, 0.5f)) };
+        list.Execute(target, views, projections);
+        RenderStats stats = list.Stats;
+
+        // Contents stick around until cleared
+        list.Execute(target, views, projections);
+        bool retained = list.Stats.drawInstances == stats.drawInstances;
+        list.Clear();
+        list.Execute(target, views, projections);
+        bool cleared = list.Stats.drawInstances == 0;
+        list.Free();
+
+        return stats.drawCalls >= 1 && stats.drawInstances == 2 && stats.culledFrustum == 1 && retained && cleared;
+    }
+
+    bool InstanceLifetime()
+    {
+        Mesh  mesh  = Mesh.GenerateCube(Vec3.One * 0.1f);
+        Model model = Model.FromMesh(mesh, Default.Material);
+        instance = new RenderInstance(model, Matrix.T(0, 0, -0.5f));
+        instance.Transform = Matrix.T(0, 0.1f, -0.5f);
+
+        // The instance holds its own references, so swapping the subset's
+        // mesh out from under it shouldn't break anything.
+        model.SetMesh(0, Mesh.GenerateSphere(0.1f));
+        instance.Destroy();
+        instance.Destroy();
+        instance.Transform = Matrix.Identity;
+
+        instance = new RenderInstance(mesh, Default.Material, Matrix.T(0, 0, -0.5f), Color.White);
+        return true;
+    }
+
+    bool OptimizeModel()
+    {
+        Model model = new Model();
+        model.AddSubset(Mesh.GenerateCube(Vec3.One), Default.Material, Matrix.T(-1, 0, 0));
+        model.AddSubset(Mesh.GenerateCube(Vec3.One), Default.Material, Matrix.T( 1, 0, 0));
+        model.AddSubset(Mesh.GenerateCube(Vec3.One), Default.MaterialUI, Matrix.Identity);
+        Bounds before = model.Bounds;
+        model.Optimize();
+        Bounds after = model.Bounds;
+        return model.SubsetCount == 2
+            && Vec3.DistanceSq(before.center, after.center) < 0.0001f
+            && Vec3.DistanceSq(before.dimensions, after.dimensions) < 0.0001f;
+    }
+
+    bool OptimizeMesh()
+    {
+        Mesh   mesh   = Mesh.GenerateSphere(1, 8);
+        int    inds   = mesh.GetInds ().Length;
+        int    verts  = mesh.GetVerts().Length;
+        Bounds bounds = mesh.Bounds;
+        mesh.Optimize(true);
+        return mesh.GetInds().Length == inds && mesh.GetVerts().Length == verts
+            && Vec3.DistanceSq(bounds.dimensions, mesh.Bounds.dimensions) < 0.0001f
+            && mesh.Intersect(new Ray(new Vec3(0, 0, 2), new Vec3(0, 0, -1)), out Vec3 at)
+            && at.z > 0.45f && at.z <= 0.5f;
+    }
+
+    bool PipelinedToggles()
+    {
+        bool start = Renderer.Pipelined;
+        Renderer.Pipelined = !start;
+        bool flipped = Renderer.Pipelined == !start;
+        Renderer.Pipelined = start;
+        return flipped && Renderer.Pipelined == start;
+    }
+
+    bool FrameSortToggles()
+    {
+        if (Renderer.Sort != RenderSort.Depth) return false;
+        Renderer.Sort = RenderSort.Material;
+        bool flipped = Renderer.Sort == RenderSort.Material;
+        Renderer.Sort = RenderSort.Depth;
+        return flipped && Renderer.Sort == RenderSort.Depth;
+    }
+
+    public void Initialize()
+    {
+        Tests.Test(ListExecutes);
+        Tests.Test(InstanceLifetime);
+        Tests.Test(OptimizeModel);
+        Tests.Test(OptimizeMesh);
+        Tests.Test(PipelinedToggles);
+        Tests.Test(FrameSortToggles);
+    }
+
+    public void Shutdown()
+    {
+        instance?.Destroy();
+    }
+    public void Update(){}
+}
\ No newline at end of file
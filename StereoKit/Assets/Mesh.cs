@@ -102,6 +102,33 @@ namespace StereoKit
 		public bool Intersect(Ray modelSpaceRay, out Vec3 modelSpaceAt)
 			=> NativeAPI.mesh_ray_intersect(_inst, modelSpaceRay, out modelSpaceAt);
 
+		/// <summary>Intersects a whole list of model space rays with this
+		/// mesh at once. The rays get split across worker threads, so this
+		/// is a lot faster than calling Intersect for each ray.</summary>
+		/// <param name="modelSpaceRays">The rays to check, in model space.</param>
+		/// <param name="modelSpaceAt">Gets the closest intersection point for
+		/// each ray, or (0,0,0) for rays that miss. Must be at least as long
+		/// as modelSpaceRays.</param>
+		/// <param name="hits">Gets whether or not each ray hit. Must be at
+		/// least as long as modelSpaceRays.</param>
+		/// <returns>How many of the rays hit.</returns>
+		public int Intersect(Ray[] modelSpaceRays, Vec3[] modelSpaceAt, bool[] hits)
+		{
+			if (modelSpaceAt.Length < modelSpaceRays.Length || hits.Length < modelSpaceRays.Length)
+				throw new ArgumentException("modelSpaceAt and hits need room for every ray!");
+			return NativeAPI.mesh_ray_intersect_batch(_inst, modelSpaceRays, modelSpaceRays.Length, modelSpaceAt, hits);
+		}
+
+		/// <summary>Reorders the mesh's triangles and vertices so the GPU's
+		/// vertex cache gets more use. The mesh looks the same afterwards,
+		/// but indices and vertex order will change, and it needs KeepData.
+		/// </summary>
+		/// <param name="overdraw">Also sort clusters of triangles so the ones
+		/// most likely to cover the others draw first. Slower to optimize,
+		/// and trades away a little vertex cache efficiency.</param>
+		public void Optimize(bool overdraw = false)
+			=> NativeAPI.mesh_optimize(_inst, overdraw);
+
 		/// <summary>Generates a plane on the XZ axis facing up that is optionally subdivided, pre-sized to the given
 		/// dimensions. UV coordinates start at 0,0 at the -X,-Z corer, and go to 1,1 at the +X,+Z corner!</summary>
 		/// <param name="dimensions">How large is this plane on the XZ axis, in meters?</param>
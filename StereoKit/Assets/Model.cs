@@ -143,6 +143,34 @@ namespace StereoKit
 		public void RecalculateBounds()
 			=> NativeAPI.model_recalculate_bounds(_inst);
 
+		/// <summary>Adds a lower detail Mesh for a subset, which draws in its
+		/// place once the subset gets small on screen.</summary>
+		/// <param name="subsetIndex">Index of the subset, should be less than SubsetCount.</param>
+		/// <param name="mesh">The lower detail Mesh, drawn with the subset's
+		/// Material.</param>
+		/// <param name="maxScreenSize">This Mesh is used once the subset
+		/// covers less than this fraction of the view's height.</param>
+		/// <returns>The LOD level this Mesh ended up at, levels are kept in
+		/// order from most to least detailed, or -1 if there are too many.
+		/// </returns>
+		public int AddLod(int subsetIndex, Mesh mesh, float maxScreenSize)
+			=> NativeAPI.model_add_lod(_inst, subsetIndex, mesh._inst, maxScreenSize);
+
+		/// <summary>Merges subsets that share a Material into a single subset,
+		/// so the Model takes fewer draw calls. Subsets with LODs, or with
+		/// Meshes that don't keep their data, are left as they are.</summary>
+		public void Optimize()
+			=> NativeAPI.model_optimize(_inst);
+
+		/// <summary>Finds the closest point where a model space ray hits any
+		/// of this Model's subsets, along with which triangle it hit.</summary>
+		/// <param name="modelSpaceRay">Ray in the Model's space.</param>
+		/// <param name="hit">Information about the closest hit, if there was
+		/// one.</param>
+		/// <returns>True if the ray hit the Model.</returns>
+		public bool Intersect(Ray modelSpaceRay, out ModelHit hit)
+			=> NativeAPI.model_ray_intersect(_inst, modelSpaceRay, out hit);
+
 		/// <summary>Adds this Model to the render queue for this frame! If the Hierarchy has a transform on it,
 		/// that transform is combined with the Matrix provided here.</summary>
 		/// <param name="transform">A Matrix that will transform the Model from Model Space into the current
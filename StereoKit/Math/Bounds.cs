@@ -1,4 +1,5 @@
-﻿using System.Runtime.CompilerServices;
+﻿using System;
+using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
 
 namespace StereoKit
@@ -64,6 +65,22 @@ namespace StereoKit
 		public bool Intersect(Ray ray, out Vec3 at)
 			=> NativeAPI.bounds_ray_intersect(this, ray, out at);
 
+		/// <summary>Intersects a whole list of rays with this bounds at once.
+		/// This is a lot faster than calling Intersect for each ray.</summary>
+		/// <param name="rays">The rays to check.</param>
+		/// <param name="at">Gets the intersection point for each ray, or
+		/// (0,0,0) for rays that miss. Must be at least as long as rays.
+		/// </param>
+		/// <param name="hits">Gets whether or not each ray hit. Must be at
+		/// least as long as rays.</param>
+		/// <returns>How many of the rays hit.</returns>
+		public int Intersect(Ray[] rays, Vec3[] at, bool[] hits)
+		{
+			if (at.Length < rays.Length || hits.Length < rays.Length)
+				throw new ArgumentException("at and hits need room for every ray!");
+			return NativeAPI.bounds_ray_intersect_batch(this, rays, rays.Length, at, hits);
+		}
+
 		/// <summary>Does the Bounds contain the given point? This includes points that are on
 		/// the surface of the Bounds.</summary>
 		/// <param name="pt">A point in the same coordinate space as the Bounds.</param>
@@ -19,6 +19,17 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern SystemInfo sk_system_info();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr     sk_version_name();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern ulong      sk_version_id();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool       sk_headless_run(int frame_count, double time_step, HeadlessStepCallback app_update, HeadlessInputCallback input_update, string report_file);
+
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern FrameStats sk_frame_stats       (int frame_count = 0);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern FrameStats sk_system_frame_stats(string system_name, int frame_count = 0);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void       sk_set_frame_budget  (float budget_ms);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern long       sk_frames_over_budget();
+
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern MemoryStats sk_memory_stats            (MemoryTag tag);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr      sk_memory_tag_name         (MemoryTag tag);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        sk_memory_dump             ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        sk_set_memory_dump_interval(float seconds);
 
 		///////////////////////////////////////////
 
@@ -67,6 +78,10 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool bounds_point_contains(Bounds bounds, Vec3 pt);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool bounds_line_contains (Bounds bounds, Vec3 linePt1, Vec3 linePt2);
 
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int  plane_ray_intersect_batch (Plane  plane,  [In] Ray[] rays, int ray_count, [Out] Vec3[] out_pts, [Out, MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.Bool)] bool[] out_hits);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int  sphere_ray_intersect_batch(Sphere sphere, [In] Ray[] rays, int ray_count, [Out] Vec3[] out_pts, [Out, MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.Bool)] bool[] out_hits);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int  bounds_ray_intersect_batch(Bounds bounds, [In] Ray[] rays, int ray_count, [Out] Vec3[] out_pts, [Out, MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.Bool)] bool[] out_hits);
+
 		///////////////////////////////////////////
 
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern Color color_hsv   (float hue, float saturation, float value, float transparency);
@@ -106,6 +121,8 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_bounds   (IntPtr mesh, in Bounds bounds);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern Bounds mesh_get_bounds   (IntPtr mesh);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   mesh_ray_intersect(IntPtr mesh, Ray model_space_ray, out Vec3 out_pt);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    mesh_ray_intersect_batch(IntPtr mesh, [In] Ray[] model_space_rays, int ray_count, [Out] Vec3[] out_pts, [Out, MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.Bool)] bool[] out_hits);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_optimize     (IntPtr mesh, bool overdraw = false);
 
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr mesh_gen_plane       (Vec2 dimensions, Vec3 plane_normal, Vec3 plane_top_direction, int subdivisions = 0);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr mesh_gen_cube        (Vec3 dimensions, int subdivisions = 0);
@@ -238,6 +255,9 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   model_recalculate_bounds(IntPtr model);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   model_set_bounds   (IntPtr model, in Bounds bounds);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern Bounds model_get_bounds   (IntPtr model);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    model_add_lod      (IntPtr model, int subset, IntPtr mesh, float max_screen_size);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   model_optimize     (IntPtr model);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   model_ray_intersect(IntPtr model, Ray model_space_ray, out ModelHit out_hit);
 
 		///////////////////////////////////////////
 
@@ -274,6 +294,26 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   render_add_model     (IntPtr model, in Matrix transform, Color color);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   render_blit          (IntPtr to_rendertarget, IntPtr material);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   render_screenshot    (Vec3 from_viewpt, Vec3 at, int width, int height, string file);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   render_add_occluder  (IntPtr mesh, in Matrix transform);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern RenderStats render_get_stats    ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_set_pipelined(bool pipelined);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool        render_get_pipelined();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_set_sort     (RenderSort sort);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern RenderSort  render_get_sort     ();
+
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr render_instance_create       (IntPtr model, in Matrix transform, Color color);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr render_instance_create_mesh  (IntPtr mesh, IntPtr material, in Matrix transform, Color color);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   render_instance_set_transform(IntPtr instance, in Matrix transform);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   render_instance_destroy      (IntPtr instance);
+
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr      render_list_create   ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_list_free     (IntPtr list);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_list_push     (IntPtr list);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_list_pop      ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_list_clear    (IntPtr list);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_list_set_sort (IntPtr list, RenderSort sort);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern RenderStats render_list_get_stats(IntPtr list);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        render_list_execute  (IntPtr list, IntPtr to_rendertarget, [In] Matrix[] views, [In] Matrix[] projections, int view_count);
 		//[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void render_get_device  (void **device, void **context);
 
 		///////////////////////////////////////////
@@ -333,6 +373,13 @@ namespace StereoKit
 
 		///////////////////////////////////////////
 
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void profiler_capture   (int frame_count, string filename);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool profiler_capturing ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void profiler_zone_begin(IntPtr name);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void profiler_zone_end  ();
+
+		///////////////////////////////////////////
+
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void ui_show_volumes(bool show);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void ui_settings    (UISettings settings);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void ui_set_color   (Color color);
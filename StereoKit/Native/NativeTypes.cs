@@ -11,7 +11,11 @@ namespace StereoKit
 		Flatscreen   = 0,
 		/// <summary>Creates an OpenXR instance, and drives display/input 
 		/// through that.</summary>
-		MixedReality = 1
+		MixedReality = 1,
+		/// <summary>No window and no XR device. Frames step with a fixed
+		/// time, for automated tests and benchmark runs, see
+		/// StereoKitApp.HeadlessRun.</summary>
+		Headless     = 2
 	}
 
 	/// <summary>StereoKit miscellaneous initialization settings! Setup 
@@ -40,6 +44,11 @@ namespace StereoKit
 		/// so developers can test MR spaces without being in a headeset. If
 		/// You don't want this, you can disable it with this setting!</summary>
 		public bool disableFlatscreenMRSim;
+		/// <summary>Models loaded from files get their meshes optimized
+		/// for the GPU's vertex cache while loading. That takes a little
+		/// extra time, and changes the vertex and index order, so this
+		/// setting lets you skip it.</summary>
+		public bool disableMeshOptimize;
 	}
 
 	/// <summary>This describes the type of display tech used on a Mixed
@@ -79,6 +88,81 @@ namespace StereoKit
 		private int _spatialBridge;
 	}
 
+	/// <summary>Frame time percentiles over the last few seconds of
+	/// frames, from StereoKitApp.GetFrameStats.</summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FrameStats
+	{
+		/// <summary>How many frames these stats cover.</summary>
+		public int   frameCount;
+		/// <summary>How many of those frames went over the frame budget.</summary>
+		public int   overBudget;
+		/// <summary>Median frame time, in milliseconds.</summary>
+		public float msP50;
+		/// <summary>95th percentile frame time, in milliseconds.</summary>
+		public float msP95;
+		/// <summary>99th percentile frame time, in milliseconds.</summary>
+		public float msP99;
+		/// <summary>Slowest frame time, in milliseconds.</summary>
+		public float msMax;
+		/// <summary>Most bytes the per-frame arena has held at once.</summary>
+		public long  frameMemPeak;
+		/// <summary>Most bytes a scratch arena has held at once.</summary>
+		public long  scratchMemPeak;
+	}
+
+	/// <summary>StereoKit's allocations are tracked by the subsystem that
+	/// made them, these are those subsystems.</summary>
+	public enum MemoryTag
+	{
+		/// <summary>Anything without a more specific tag.</summary>
+		General = 0,
+		/// <summary>Mesh assets and their collision data.</summary>
+		Mesh,
+		/// <summary>Texture assets.</summary>
+		Tex,
+		/// <summary>Shader assets.</summary>
+		Shader,
+		/// <summary>Material assets.</summary>
+		Material,
+		/// <summary>Model assets.</summary>
+		Model,
+		/// <summary>Font assets.</summary>
+		Font,
+		/// <summary>Sprite assets.</summary>
+		Sprite,
+		/// <summary>Sound assets.</summary>
+		Sound,
+		/// <summary>The renderer's queues and lists.</summary>
+		Render,
+		/// <summary>The text system.</summary>
+		Text,
+		/// <summary>The UI system.</summary>
+		UI,
+		/// <summary>The audio system.</summary>
+		Audio,
+		/// <summary>The physics system.</summary>
+		Physics,
+		/// <summary>The log and its listeners.</summary>
+		Log,
+		/// <summary>The number of tags, not a tag itself.</summary>
+		Max,
+	}
+
+	/// <summary>Allocation counts for a single MemoryTag.</summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct MemoryStats
+	{
+		/// <summary>Bytes currently allocated.</summary>
+		public long liveBytes;
+		/// <summary>Most bytes that were ever allocated at once.</summary>
+		public long peakBytes;
+		/// <summary>Allocations that haven't been freed yet.</summary>
+		public long liveCount;
+		/// <summary>Allocations made since startup.</summary>
+		public long totalCount;
+	}
+
 	/// <summary>Visual properties and spacing of the UI system.</summary>
 	[StructLayout(LayoutKind.Sequential)]
 	public struct UISettings
@@ -547,6 +631,12 @@ namespace StereoKit
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
 	public delegate float AudioGenerator(float time);
 
+	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+	public delegate void HeadlessStepCallback();
+
+	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+	public delegate void HeadlessInputCallback(int frame);
+
 
 	/// <summary>Index values for each finger! From 0-4, from thumb to little finger.</summary>
 	public enum FingerId
@@ -615,4 +705,74 @@ namespace StereoKit
 		/// <summary>Flag to include a body on the window.</summary>
 		Body = 1 << 1,
 	}
+
+	/// <summary>How a render list orders its draws.</summary>
+	public enum RenderSort
+	{
+		/// <summary>Groups draws by material and mesh, for the fewest state
+		/// changes.</summary>
+		Material = 0,
+		/// <summary>Opaque draws go front to back and transparent ones back
+		/// to front, still grouped by material where depth allows.</summary>
+		Depth,
+	}
+
+	/// <summary>Draw counts and CPU timings from the renderer. Which
+	/// frame and list these cover depends on where they came from, see
+	/// Renderer.Stats and RenderList.Stats. Apart from the LOD counts,
+	/// they describe the latest time the list was drawn, and screenshots
+	/// are left out.</summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct RenderStats
+	{
+		/// <summary>How many times the bound mesh changed.</summary>
+		public int   swapsMesh;
+		/// <summary>How many times the bound shader changed.</summary>
+		public int   swapsShader;
+		/// <summary>How many times a bound texture changed.</summary>
+		public int   swapsTexture;
+		/// <summary>How many times the bound material changed.</summary>
+		public int   swapsMaterial;
+		/// <summary>Number of draw calls sent to the GPU.</summary>
+		public int   drawCalls;
+		/// <summary>Number of instances drawn across all draw calls.</summary>
+		public int   drawInstances;
+		/// <summary>Items skipped for being outside the view frustums.</summary>
+		public int   culledFrustum;
+		/// <summary>Items skipped for being hidden behind occluders.</summary>
+		public int   culledOcclusion;
+		private int  _lod0, _lod1, _lod2, _lod3, _lod4, _lod5, _lod6, _lod7;
+		/// <summary>Milliseconds spent on frustum culling.</summary>
+		public float msCull;
+		/// <summary>Milliseconds spent on occlusion culling.</summary>
+		public float msOcclusion;
+		/// <summary>Milliseconds spent sorting draws.</summary>
+		public float msSort;
+		/// <summary>Milliseconds spent building instance data.</summary>
+		public float msInstances;
+		/// <summary>Milliseconds spent submitting draws to the GPU.</summary>
+		public float msSubmit;
+
+		/// <summary>How many model subsets drew at each LOD level, with
+		/// level 0 being the original mesh.</summary>
+		public int[] LodCounts => new int[] { _lod0, _lod1, _lod2, _lod3, _lod4, _lod5, _lod6, _lod7 };
+	}
+
+	/// <summary>Where a ray hit a Model, from Model.Intersect.</summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct ModelHit
+	{
+		/// <summary>The hit point, in model space.</summary>
+		public Vec3  pt;
+		/// <summary>Distance along the ray, in units of the ray's
+		/// direction.</summary>
+		public float distance;
+		/// <summary>Index of the subset that was hit.</summary>
+		public int   subset;
+		/// <summary>Which triangle of the subset's mesh was hit. Its verts
+		/// are at indices triangle*3 through triangle*3+2.</summary>
+		public int   triangle;
+		/// <summary>Weights of the triangle's three verts at the hit point.</summary>
+		public Vec3  barycentric;
+	}
 }
\ No newline at end of file
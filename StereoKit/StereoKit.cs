@@ -92,6 +92,58 @@ namespace StereoKit
 			});
 		}
 
+		/// <summary>Runs StereoKit for a fixed number of frames, as fast as
+		/// it can go, with a fixed time step. This is for automated tests
+		/// and benchmarks, and needs StereoKit to be initialized with
+		/// Runtime.Headless.</summary>
+		/// <param name="frameCount">How many frames to run.</param>
+		/// <param name="timeStep">Seconds each frame advances the clock by.
+		/// Must be greater than zero.</param>
+		/// <param name="onStep">Application code, called each frame just like
+		/// the callback for Step.</param>
+		/// <param name="onInput">Called at the start of each frame with the
+		/// frame's index, so a run can script its own input.</param>
+		/// <param name="reportFile">If not null, a JSON report of frame and
+		/// system timings gets written here when the run finishes.</param>
+		/// <returns>False if StereoKit wasn't initialized headless, or the
+		/// report couldn't be written.</returns>
+		public static bool HeadlessRun(int frameCount, double timeStep, Action onStep = null, Action<int> onInput = null, string reportFile = null)
+		{
+			HeadlessStepCallback  step  = () => { _steppers.Step(); onStep?.Invoke(); };
+			HeadlessInputCallback input = onInput == null ? null : new HeadlessInputCallback(onInput);
+			bool result = NativeAPI.sk_headless_run(frameCount, timeStep, step, input, reportFile);
+			GC.KeepAlive(step);
+			GC.KeepAlive(input);
+			return result;
+		}
+
+		/// <summary>Frame time percentiles for the most recent frames.</summary>
+		/// <param name="frameCount">How many of the most recent frames to
+		/// include, zero for all the history StereoKit keeps.</param>
+		/// <returns>Frame time stats, along with the peak frame and scratch
+		/// memory use.</returns>
+		public static FrameStats GetFrameStats(int frameCount = 0)
+			=> NativeAPI.sk_frame_stats(frameCount);
+
+		/// <summary>Like GetFrameStats, but for the time a single StereoKit
+		/// system spent on its update each frame.</summary>
+		/// <param name="systemName">Name of the system, like "Renderer" or
+		/// "Input".</param>
+		/// <param name="frameCount">How many of the most recent frames to
+		/// include, zero for all the history StereoKit keeps.</param>
+		/// <returns>Update time stats for the system, or all zeros if there's
+		/// no system with that name.</returns>
+		public static FrameStats GetSystemFrameStats(string systemName, int frameCount = 0)
+			=> NativeAPI.sk_system_frame_stats(systemName, frameCount);
+
+		/// <summary>Frames that take longer than this many milliseconds count
+		/// as over budget. Defaults to 60fps worth of time.</summary>
+		public static float FrameBudget { set => NativeAPI.sk_set_frame_budget(value); }
+
+		/// <summary>How many frames have gone over FrameBudget since
+		/// StereoKit started.</summary>
+		public static long FramesOverBudget => NativeAPI.sk_frames_over_budget();
+
 		public static T AddStepper<T>(T stepper) where T:IStepper => _steppers.Add(stepper);
 		public static T AddStepper<T>() where T:IStepper => _steppers.Add<T>();
 		public static void RemoveStepper(IStepper stepper) => _steppers.Remove(stepper);
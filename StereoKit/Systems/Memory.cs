@@ -0,0 +1,30 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace StereoKit
+{
+	/// <summary>StereoKit tracks its own allocations by which subsystem
+	/// made them. This is where you can look at those numbers.</summary>
+	public static class Memory
+	{
+		/// <summary>Logs the stats of every MemoryTag every few seconds,
+		/// zero to turn it off. Off by default.</summary>
+		public static float DumpInterval { set => NativeAPI.sk_set_memory_dump_interval(value); }
+
+		/// <summary>Allocation stats for one subsystem.</summary>
+		/// <param name="tag">Which subsystem.</param>
+		/// <returns>Live and peak bytes, and allocation counts.</returns>
+		public static MemoryStats GetStats(MemoryTag tag)
+			=> NativeAPI.sk_memory_stats(tag);
+
+		/// <summary>The name StereoKit uses for a tag in its logs.</summary>
+		/// <param name="tag">Which subsystem.</param>
+		/// <returns>A short, human readable name.</returns>
+		public static string TagName(MemoryTag tag)
+			=> Marshal.PtrToStringAnsi(NativeAPI.sk_memory_tag_name(tag));
+
+		/// <summary>Logs the stats of every MemoryTag right away.</summary>
+		public static void Dump()
+			=> NativeAPI.sk_memory_dump();
+	}
+}
\ No newline at end of file
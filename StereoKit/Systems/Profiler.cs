@@ -0,0 +1,50 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+
+namespace StereoKit
+{
+	/// <summary>A CPU profiler for StereoKit and your own code! Captures
+	/// are written in Chrome's trace format, so they open up in Perfetto or
+	/// chrome://tracing, where you can see what each thread was doing.</summary>
+	public static class Profiler
+	{
+		// Zones keep a pointer to their name, so names need to stick around
+		// for as long as a capture could reference them.
+		static Dictionary<string, IntPtr> zoneNames = new Dictionary<string, IntPtr>();
+
+		/// <summary>Is a capture waiting to start, or in progress?</summary>
+		public static bool IsCapturing => NativeAPI.profiler_capturing();
+
+		/// <summary>Captures the next few frames, and writes them to file
+		/// once they're done.</summary>
+		/// <param name="frameCount">How many frames to capture.</param>
+		/// <param name="filename">Where to write the trace, usually a .json
+		/// file.</param>
+		public static void Capture(int frameCount, string filename)
+			=> NativeAPI.profiler_capture(frameCount, filename);
+
+		/// <summary>Starts a named zone on this thread, which lasts until the
+		/// matching ZoneEnd. Zones can nest.</summary>
+		/// <param name="name">The zone's name in the capture. Reuse names
+		/// where you can, each unique name is kept around for good.</param>
+		public static void ZoneBegin(string name)
+		{
+			IntPtr ptr;
+			lock (zoneNames)
+			{
+				if (!zoneNames.TryGetValue(name, out ptr))
+				{
+					ptr = Marshal.StringToHGlobalAnsi(name);
+					zoneNames.Add(name, ptr);
+				}
+			}
+			NativeAPI.profiler_zone_begin(ptr);
+		}
+
+		/// <summary>Ends the zone from the last ZoneBegin on this thread.
+		/// </summary>
+		public static void ZoneEnd()
+			=> NativeAPI.profiler_zone_end();
+	}
+}
\ No newline at end of file
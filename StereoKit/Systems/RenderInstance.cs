@@ -0,0 +1,56 @@
+﻿using System;
+
+namespace StereoKit
+{
+	/// <summary>A Model or Mesh that stays in the scene until it's
+	/// destroyed, instead of being added to the render queue every frame.
+	/// StereoKit keeps these sorted and their instance data built, so a
+	/// large, mostly static scene costs far less CPU each frame.
+	///
+	/// Instances aren't tied to the lifetime of this object, so make sure to
+	/// call Destroy when it should leave the scene.</summary>
+	public class RenderInstance
+	{
+		internal IntPtr _inst;
+
+		/// <summary>Moves the instance. Like Renderer.Add, this gets combined
+		/// with the current Hierarchy transform.</summary>
+		public Matrix Transform { set { if (_inst != IntPtr.Zero) NativeAPI.render_instance_set_transform(_inst, value); } }
+
+		/// <summary>Adds a Model to the scene until Destroy is called.</summary>
+		/// <param name="model">A valid Model, the instance holds its own
+		/// reference to it.</param>
+		/// <param name="transform">Transforms the Model into the current
+		/// Hierarchy space.</param>
+		public RenderInstance(Model model, Matrix transform)
+			=> _inst = NativeAPI.render_instance_create(model._inst, transform, Color.White);
+		/// <summary>Adds a Model to the scene until Destroy is called.</summary>
+		/// <param name="model">A valid Model, the instance holds its own
+		/// reference to it.</param>
+		/// <param name="transform">Transforms the Model into the current
+		/// Hierarchy space.</param>
+		/// <param name="color">A per-instance color value to pass into the
+		/// shader.</param>
+		public RenderInstance(Model model, Matrix transform, Color color)
+			=> _inst = NativeAPI.render_instance_create(model._inst, transform, color);
+		/// <summary>Adds a Mesh to the scene until Destroy is called.</summary>
+		/// <param name="mesh">A valid Mesh, the instance holds its own
+		/// reference to it.</param>
+		/// <param name="material">A Material to draw the Mesh with.</param>
+		/// <param name="transform">Transforms the Mesh into the current
+		/// Hierarchy space.</param>
+		/// <param name="color">A per-instance color value to pass into the
+		/// shader.</param>
+		public RenderInstance(Mesh mesh, Material material, Matrix transform, Color color)
+			=> _inst = NativeAPI.render_instance_create_mesh(mesh._inst, material._inst, transform, color);
+
+		/// <summary>Removes the instance from the scene, and releases its
+		/// references to its assets. It can't be used after this.</summary>
+		public void Destroy()
+		{
+			if (_inst != IntPtr.Zero)
+				NativeAPI.render_instance_destroy(_inst);
+			_inst = IntPtr.Zero;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+﻿using System;
+
+namespace StereoKit
+{
+	/// <summary>A render queue you can fill up and draw yourself! While a
+	/// RenderList is pushed, Renderer.Add and friends go into it instead of
+	/// the frame's queue. Its contents stay until Clear is called, so a
+	/// list that doesn't change can be drawn again without re-adding
+	/// anything, and skips most of the work of sorting and culling.
+	///
+	/// Lists aren't tied to the lifetime of this object, so call Free when
+	/// you're done with one.</summary>
+	public class RenderList
+	{
+		internal IntPtr _inst;
+
+		/// <summary>Draw counts and timings from the last time this list was
+		/// drawn.</summary>
+		public RenderStats Stats => NativeAPI.render_list_get_stats(_inst);
+
+		/// <summary>How this list orders its draws. New lists sort by depth.
+		/// </summary>
+		public RenderSort Sort { set => NativeAPI.render_list_set_sort(_inst, value); }
+
+		/// <summary>Creates a new, empty render list.</summary>
+		public RenderList()
+			=> _inst = NativeAPI.render_list_create();
+
+		/// <summary>Frees the list and everything in it. The list can't be
+		/// pushed when this is called, and can't be used after this.</summary>
+		public void Free()
+		{
+			if (_inst != IntPtr.Zero)
+				NativeAPI.render_list_free(_inst);
+			_inst = IntPtr.Zero;
+		}
+
+		/// <summary>Sends Renderer.Add calls into this list, until the
+		/// matching Pop.</summary>
+		public void Push()
+			=> NativeAPI.render_list_push(_inst);
+
+		/// <summary>Goes back to whichever list was active before the last
+		/// Push.</summary>
+		public static void Pop()
+			=> NativeAPI.render_list_pop();
+
+		/// <summary>Removes everything that's been added to this list.</summary>
+		public void Clear()
+			=> NativeAPI.render_list_clear(_inst);
+
+		/// <summary>Draws this list right away, from one or two viewpoints.
+		/// </summary>
+		/// <param name="toRendertarget">A render target texture to draw to,
+		/// or null to draw to whatever target is currently active.</param>
+		/// <param name="views">View matrices, one for each eye.</param>
+		/// <param name="projections">Projection matrices, one for each view.
+		/// </param>
+		public void Execute(Tex toRendertarget, Matrix[] views, Matrix[] projections)
+		{
+			if (views.Length != projections.Length)
+				throw new ArgumentException("Each view needs a projection!");
+			NativeAPI.render_list_execute(_inst, toRendertarget == null ? IntPtr.Zero : toRendertarget._inst, views, projections, views.Length);
+		}
+	}
+}
\ No newline at end of file
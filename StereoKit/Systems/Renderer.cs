@@ -134,5 +134,40 @@ namespace StereoKit
 		public static void Screenshot(Vec3 from, Vec3 at, int width, int height, string filename)
 			=> NativeAPI.render_screenshot(from, at, width, height, filename);
 
+		/// <summary>Adds a Mesh as an occluder for this frame. Occluders don't
+		/// draw, but anything fully hidden behind them gets culled before it
+		/// reaches the GPU. Walls and large solid objects make good occluders.
+		/// </summary>
+		/// <param name="mesh">A low detail Mesh that sits inside the visible
+		/// surface.</param>
+		/// <param name="transform">A Matrix that will transform the mesh from
+		/// Model Space into the current Hierarchy Space.</param>
+		public static void AddOccluder(Mesh mesh, Matrix transform)
+			=> NativeAPI.render_add_occluder(mesh._inst, transform);
+
+		/// <summary>Draw counts and timings from the last frame that was
+		/// rendered.</summary>
+		public static RenderStats Stats => NativeAPI.render_get_stats();
+
+		/// <summary>When pipelined, the renderer submits a frame to the GPU
+		/// on its own thread while the next frame updates. This adds a frame
+		/// of latency, in exchange for more time each frame. Mixed reality
+		/// runtimes always render on the main thread.</summary>
+		public static bool Pipelined
+		{
+			get => NativeAPI.render_get_pipelined();
+			set => NativeAPI.render_set_pipelined(value);
+		}
+
+		/// <summary>How the frame's draws get ordered. Depth sorting is the
+		/// default, and draws near to far. Material sorting skips the depth
+		/// math and groups draws by state instead, which can save time in
+		/// scenes with lots of cheap draws.</summary>
+		public static RenderSort Sort
+		{
+			get => NativeAPI.render_get_sort();
+			set => NativeAPI.render_set_sort(value);
+		}
+
 	}
 }
\ No newline at end of file
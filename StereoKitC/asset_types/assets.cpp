@@ -11,6 +11,7 @@
 #include "sound.h"
 #include "../libraries/stref.h"
 #include "../libraries/array.h"
+#include "../systems/memory_track.h"
 
 #include <stdio.h>
 #include <assert.h>
@@ -70,7 +71,12 @@ void *assets_allocate(asset_type_ type) {
 	char name[64];
 	sprintf_s(name, "auto/asset_%d", assets.count);
 
-	asset_header_t *header = (asset_header_t *)malloc(size);
+	// Asset tags are in the same order as the asset types
+	asset_header_t *header = nullptr;
+	{
+		memory_scope((memory_tag_)(memory_tag_mesh + type));
+		header = (asset_header_t *)sk_malloc(size);
+	}
 	memset(header, 0, size);
 	header->type  = type;
 	header->refs += 1;
@@ -140,7 +146,7 @@ void  assets_releaseref(asset_header_t &asset) {
 #ifdef _DEBUG
 	free(asset.id_text);
 #endif
-	free(&asset);
+	sk_free(&asset);
 }
 
 ///////////////////////////////////////////
@@ -2,6 +2,7 @@
 #include "texture.h"
 #include "../systems/d3d.h"
 #include "../libraries/stref.h"
+#include "../systems/memory_track.h"
 
 #include <stdio.h>
 
@@ -40,8 +41,9 @@ inline size_t material_param_size(material_param_ type) {
 ///////////////////////////////////////////
 
 void material_create_arg_defaults(material_t material, shader_t shader) {
-	material->args.buffer   = malloc(shader->args.buffer_size);
-	material->args.textures = (tex_t*)malloc(sizeof(tex_t)*shader->tex_slots.tex_count);
+	memory_scope(memory_tag_material);
+	material->args.buffer   = sk_malloc(shader->args.buffer_size);
+	material->args.textures = (tex_t*)sk_malloc(sizeof(tex_t)*shader->tex_slots.tex_count);
 	memset(material->args.buffer,   0, shader->args.buffer_size);
 	memset(material->args.textures, 0, sizeof(tex_t) * shader->tex_slots.tex_count);
 
@@ -123,8 +125,8 @@ void material_destroy(material_t material) {
 	}
 	shader_release(material->shader);
 	if (material->blend_state != nullptr) material->blend_state->Release();
-	free(material->args.buffer);
-	free(material->args.textures);
+	sk_free(material->args.buffer);
+	sk_free(material->args.textures);
 	*material = {};
 }
 
@@ -177,8 +179,8 @@ void material_set_shader(material_t material, shader_t shader) {
 			tex_release(old_textures[i]);
 		}
 
-		free(old_buffer);
-		free(old_textures);
+		sk_free(old_buffer);
+		sk_free(old_textures);
 	}
 
 	// Update references
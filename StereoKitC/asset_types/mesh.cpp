@@ -2,6 +2,10 @@
 #include "../systems/d3d.h"
 #include "mesh.h"
 #include "assets.h"
+#include "../systems/memory_track.h"
+#include "../math.h"
+#include "mesh_optimize.h"
+#include "../systems/frame_alloc.h"
 
 #include <stdio.h>
 
@@ -14,14 +18,18 @@ namespace sk {
 ///////////////////////////////////////////
 
 ID3D11InputLayout *vert_t_layout = nullptr;
+// Mesh rays cost a lot more than primitive ones, so they split into jobs
+// much sooner.
+const int32_t      mesh_ray_job_size = 32;
 
 ///////////////////////////////////////////
 
 void mesh_set_keep_data(mesh_t mesh, bool32_t keep_data) {
 	mesh->discard_data = !keep_data;
 	if (mesh->discard_data) {
-		free(mesh->verts); mesh->verts = nullptr;
-		free(mesh->inds ); mesh->inds  = nullptr;
+		mesh_collision_free(mesh);
+		sk_free(mesh->verts); mesh->verts = nullptr;
+		sk_free(mesh->inds ); mesh->inds  = nullptr;
 	}
 }
 
@@ -34,10 +42,12 @@ bool32_t mesh_get_keep_data(mesh_t mesh) {
 ///////////////////////////////////////////
 
 void mesh_set_verts(mesh_t mesh, vert_t *vertices, int32_t vertex_count, bool32_t calculate_bounds) {
+	memory_scope(memory_tag_mesh);
+
 	// Keep track of vertex data for use on CPU side
 	if (!mesh->discard_data) {
 		if (mesh->vert_capacity < vertex_count)
-			mesh->verts = (vert_t*)realloc(mesh->verts, vertex_count * sizeof(vert_t));
+			mesh->verts = (vert_t*)sk_realloc(mesh->verts, vertex_count * sizeof(vert_t));
 		memcpy(mesh->verts, vertices, sizeof(vert_t) * vertex_count);
 	}
 
@@ -75,7 +85,10 @@ void mesh_set_verts(mesh_t mesh, vert_t *vertices, int32_t vertex_count, bool32_
 		d3d_context->Unmap(mesh->vert_buffer, 0);
 	}
 
-	mesh->vert_count = vertex_count;
+	mesh->vert_count  = vertex_count;
+	mesh->generation += 1;
+	// Collision data gets rebuilt from the new verts the next time it's needed
+	mesh_collision_free(mesh);
 
 	// Calculate the bounds for this mesh by searching it for min and max values!
 	if (calculate_bounds && vertex_count > 0) {
@@ -111,8 +124,9 @@ void mesh_set_inds (mesh_t mesh, vind_t *indices,  int32_t index_count) {
 
 	// Keep track of index data for use on CPU side
 	if (!mesh->discard_data) {
+		memory_scope(memory_tag_mesh);
 		if (mesh->ind_capacity < index_count)
-			mesh->inds = (vind_t*)realloc(mesh->inds, index_count * sizeof(vind_t));
+			mesh->inds = (vind_t*)sk_realloc(mesh->inds, index_count * sizeof(vind_t));
 		memcpy(mesh->inds, indices, sizeof(vind_t) * index_count);
 	}
 
@@ -150,8 +164,10 @@ void mesh_set_inds (mesh_t mesh, vind_t *indices,  int32_t index_count) {
 		d3d_context->Unmap(mesh->ind_buffer, 0);
 	}
 
-	mesh->ind_count = index_count;
-	mesh->ind_draw  = index_count;
+	mesh->ind_count   = index_count;
+	mesh->ind_draw    = index_count;
+	mesh->generation += 1;
+	mesh_collision_free(mesh);
 }
 
 ///////////////////////////////////////////
@@ -174,7 +190,8 @@ void mesh_set_draw_inds(mesh_t mesh, int32_t index_count) {
 ///////////////////////////////////////////
 
 void mesh_set_bounds(mesh_t mesh, const bounds_t &bounds) {
-	mesh->bounds = bounds;
+	mesh->bounds      = bounds;
+	mesh->generation += 1;
 }
 
 ///////////////////////////////////////////
@@ -214,25 +231,26 @@ mesh_t mesh_create() {
 
 ///////////////////////////////////////////
 
+void mesh_collision_free(mesh_t mesh) {
+	sk_free(mesh->collision_data.tris);
+	mesh_bvh_free(mesh->collision_data.bvh);
+	mesh->collision_data = {};
+}
+
+///////////////////////////////////////////
+
 const mesh_collision_t *mesh_get_collision_data(mesh_t mesh) {
-	if (mesh->collision_data.pts != nullptr)
+	if (mesh->collision_data.tris != nullptr)
 		return &mesh->collision_data;
-	if (mesh->discard_data)
+	if (mesh->discard_data || mesh->verts == nullptr || mesh->inds == nullptr)
 		return nullptr;
 
+	memory_scope(memory_tag_mesh);
 	mesh_collision_t &coll = mesh->collision_data;
-	coll.pts    = (vec3*)   malloc(sizeof(vec3)    * mesh->ind_count);
-	coll.planes = (plane_t*)malloc(sizeof(plane_t) * mesh->ind_count/3);
-
-	for (int32_t i = 0; i < mesh->ind_count; i++) coll.pts[i] = mesh->verts[mesh->inds[i]].pos;
-
-	for (int32_t i = 0; i < mesh->ind_count; i += 3) {
-		vec3    dir1   = coll.pts[i+1] - coll.pts[i];
-		vec3    dir2   = coll.pts[i+1] - coll.pts[i+2];
-		vec3    normal = vec3_normalize( vec3_cross(dir1, dir2) );
-		plane_t plane  = { normal, -vec3_dot(coll.pts[i + 1], normal) };
-		coll.planes[i/3] = plane;
-	}
+	coll.verts     = mesh->verts;
+	coll.inds      = mesh->inds;
+	coll.tri_count = mesh->ind_count / 3;
+	mesh_bvh_build(coll);
 
 	return &mesh->collision_data;
 }
@@ -250,61 +268,66 @@ void mesh_release(mesh_t mesh) {
 void mesh_destroy(mesh_t mesh) {
 	if (mesh->ind_buffer  != nullptr) mesh->ind_buffer ->Release();
 	if (mesh->vert_buffer != nullptr) mesh->vert_buffer->Release();
-	free(mesh->verts);
-	free(mesh->inds);
-	free(mesh->collision_data.pts   );
-	free(mesh->collision_data.planes);
+	sk_free(mesh->verts);
+	sk_free(mesh->inds);
+	mesh_collision_free(mesh);
 	*mesh = {};
 }
 
 ///////////////////////////////////////////
 
 bool32_t mesh_ray_intersect(mesh_t mesh, ray_t model_space_ray, vec3 *out_pt) {
-	vec3 result = {};
-
 	const mesh_collision_t *data = mesh_get_collision_data(mesh);
 	if (data == nullptr)
 		return false;
-	if (!bounds_ray_intersect(mesh->bounds, model_space_ray, &result))
+	// The BVH's root node already covers the mesh bounds
+	mesh_bvh_hit_t hit;
+	if (!mesh_bvh_intersect(*data, model_space_ray, FLT_MAX, &hit))
 		return false;
+	*out_pt = model_space_ray.pos + model_space_ray.dir * hit.distance;
+	return true;
+}
 
-	vec3  pt = {};
-	float nearest_dist = FLT_MAX;
-	for (int32_t i = 0; i < mesh->ind_count; i+=3) {
-		if (!plane_ray_intersect(data->planes[i / 3], model_space_ray, &pt))
-			continue;
-
-		// point in triangle, implementation based on:
-		// https://blackpawn.com/texts/pointinpoly/default.html
-
-		// Compute vectors
-		vec3 v0 = data->pts[i+1] - data->pts[i];
-		vec3 v1 = data->pts[i+2] - data->pts[i];
-		vec3 v2 = pt - data->pts[i];
-
-		// Compute dot products
-		float dot00 = vec3_dot(v0, v0);
-		float dot01 = vec3_dot(v0, v1);
-		float dot02 = vec3_dot(v0, v2);
-		float dot11 = vec3_dot(v1, v1);
-		float dot12 = vec3_dot(v1, v2);
-
-		// Compute barycentric coordinates
-		float inv_denom = 1.0f / (dot00 * dot11 - dot01 * dot01);
-		float u = (dot11 * dot02 - dot01 * dot12) * inv_denom;
-		float v = (dot00 * dot12 - dot01 * dot02) * inv_denom;
-
-		// Check if point is in triangle
-		if ((u >= 0) && (v >= 0) && (u + v < 1)) {
-			float dist = vec3_magnitude_sq(pt - model_space_ray.pos);
-			if (dist < nearest_dist) {
-				nearest_dist = dist;
-				*out_pt      = pt;
-			}
-		}
+///////////////////////////////////////////
+
+int32_t mesh_ray_intersect_batch(mesh_t mesh, const ray_t *model_space_rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits) {
+	// Built up front, so the jobs don't race each other to make it
+	const mesh_collision_t *data = mesh_get_collision_data(mesh);
+	if (data == nullptr) {
+		memset(out_pts,  0, sizeof(vec3)     * ray_count);
+		memset(out_hits, 0, sizeof(bool32_t) * ray_count);
+		return 0;
+	}
+	return ray_batch_run(*data, model_space_rays, ray_count, out_pts, out_hits, mesh_ray_job_size);
+}
+
+///////////////////////////////////////////
+
+void mesh_optimize(mesh_t mesh, bool32_t overdraw) {
+	if (mesh->verts == nullptr || mesh->inds == nullptr) {
+		log_warn("mesh_optimize: needs the mesh's CPU side data, see mesh_set_keep_data");
+		return;
 	}
 
-	return nearest_dist != FLT_MAX;
+	frame_mark_t mark       = frame_scratch_mark();
+	int32_t      vert_count = mesh->vert_count;
+	int32_t      ind_count  = mesh->ind_count;
+	vert_t      *verts      = (vert_t*)frame_scratch_alloc(sizeof(vert_t) * vert_count);
+	vind_t      *inds       = (vind_t*)frame_scratch_alloc(sizeof(vind_t) * ind_count);
+	memcpy(verts, mesh->verts, sizeof(vert_t) * vert_count);
+	memcpy(inds,  mesh->inds,  sizeof(vind_t) * ind_count);
+
+	if (mesh_optimize_data(verts, vert_count, inds, ind_count, overdraw)) {
+		// Static buffers would turn dynamic on the next set, so start over
+		// with fresh static ones instead.
+		if (!mesh->vert_dynamic && mesh->vert_buffer != nullptr) { mesh->vert_buffer->Release(); mesh->vert_buffer = nullptr; }
+		if (!mesh->ind_dynamic  && mesh->ind_buffer  != nullptr) { mesh->ind_buffer ->Release(); mesh->ind_buffer  = nullptr; }
+		mesh_set_verts(mesh, verts, vert_count, false);
+		mesh_set_inds (mesh, inds,  ind_count);
+	} else {
+		log_warn("mesh_optimize: the mesh has bad indices, leaving it as is");
+	}
+	frame_scratch_release(mark);
 }
 
 ///////////////////////////////////////////
@@ -5,12 +5,18 @@
 
 #include "../stereokit.h"
 #include "assets.h"
+#include "mesh_bvh.h"
 
 namespace sk {
 
+// Geometry comes straight from the mesh's own verts and inds, so this only
+// adds the BVH, and the triangle indices its leaves refer to.
 struct mesh_collision_t {
-	vec3*    pts;
-	plane_t* planes;
+	const vert_t* verts;
+	const vind_t* inds;
+	uint32_t*     tris;
+	int32_t       tri_count;
+	mesh_bvh_t    bvh;
 };
 
 struct _mesh_t {
@@ -29,9 +35,13 @@ struct _mesh_t {
 	vert_t*        verts;
 	vind_t*        inds;
 	mesh_collision_t collision_data;
+	// Bumped whenever the verts, inds or bounds change, so anything cached
+	// from them can tell it's stale.
+	uint32_t       generation;
 };
 
 const mesh_collision_t *mesh_get_collision_data(mesh_t mesh);
+void mesh_collision_free(mesh_t mesh);
 void mesh_destroy(mesh_t mesh);
 
 } // namespace sk
\ No newline at end of file
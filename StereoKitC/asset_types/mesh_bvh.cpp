@@ -0,0 +1,384 @@
+// Binned SAH build, based on:
+// https://www.sci.utah.edu/~wald/Publications/2007/ParallelBVHBuild/fastbuild.pdf
+
+#include "mesh_bvh.h"
+#include "mesh.h"
+#include "../math.h"
+#include "../libraries/array.h"
+#include "../systems/frame_alloc.h"
+#include "../systems/memory_track.h"
+
+#include <float.h>
+#include <math.h>
+
+using namespace DirectX;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct bvh_prim_t {
+	vec3 min;
+	vec3 max;
+	vec3 center;
+};
+
+struct bvh_bin_t {
+	vec3    min;
+	vec3    max;
+	int32_t count;
+};
+
+///////////////////////////////////////////
+
+const int32_t bvh_bin_count = 12;
+const int32_t bvh_leaf_min  = 4;
+const int32_t bvh_leaf_max  = 8;
+// Cost of visiting a node, relative to testing one triangle
+const float   bvh_node_cost = 1.0f;
+
+///////////////////////////////////////////
+
+inline float bvh_area(const vec3 &min, const vec3 &max) {
+	vec3 size = max - min;
+	return size.x*size.y + size.y*size.z + size.z*size.x;
+}
+
+///////////////////////////////////////////
+
+inline void bvh_grow(vec3 &min, vec3 &max, const vec3 &pt_min, const vec3 &pt_max) {
+	min = { fminf(min.x, pt_min.x), fminf(min.y, pt_min.y), fminf(min.z, pt_min.z) };
+	max = { fmaxf(max.x, pt_max.x), fmaxf(max.y, pt_max.y), fmaxf(max.z, pt_max.z) };
+}
+
+///////////////////////////////////////////
+
+void mesh_bvh_build_boxes(const mesh_bvh_box_t *boxes, int32_t count, mesh_bvh_t &out_bvh, uint32_t *out_order) {
+	out_bvh = {};
+	if (count <= 0)
+		return;
+
+	frame_mark_t mark  = frame_scratch_mark();
+	bvh_prim_t  *prims = (bvh_prim_t*)frame_scratch_alloc(sizeof(bvh_prim_t) * count);
+	uint8_t     *depth = (uint8_t   *)frame_scratch_alloc(sizeof(uint8_t)    * count * 2);
+	uint32_t    *order = out_order;
+
+	mesh_bvh_node_t root = { { FLT_MAX, FLT_MAX, FLT_MAX }, 0, { -FLT_MAX, -FLT_MAX, -FLT_MAX }, (uint32_t)count };
+	for (int32_t i = 0; i < count; i++) {
+		prims[i] = { boxes[i].min, boxes[i].max, (boxes[i].min + boxes[i].max) * 0.5f };
+		order[i] = (uint32_t)i;
+		bvh_grow(root.min, root.max, boxes[i].min, boxes[i].max);
+	}
+
+	// A binary tree never needs more than 2n-1 nodes. Children get added
+	// to the end of the list, so walking it in order visits each node
+	// after its parent, with no recursion needed.
+	array_t<mesh_bvh_node_t> nodes = {};
+	nodes.resize(count * 2);
+	nodes.add(root);
+	depth[0] = 0;
+
+	bvh_bin_t bins[bvh_bin_count];
+	for (int32_t n = 0; n < nodes.count; n++) {
+		mesh_bvh_node_t node = nodes[n];
+		if (node.count <= (uint32_t)bvh_leaf_min || depth[n] >= mesh_bvh_max_depth)
+			continue;
+
+		// Bin along the longest axis of the box centers
+		vec3 center_min = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+		vec3 center_max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (uint32_t i = node.start; i < node.start + node.count; i++)
+			bvh_grow(center_min, center_max, prims[order[i]].center, prims[order[i]].center);
+		vec3    extent = center_max - center_min;
+		int32_t axis   = extent.x > extent.y
+			? (extent.x > extent.z ? 0 : 2)
+			: (extent.y > extent.z ? 1 : 2);
+		float axis_min    = (&center_min.x)[axis];
+		float axis_extent = (&extent.x)[axis];
+		if (axis_extent <= 0)
+			continue;
+
+		for (int32_t b = 0; b < bvh_bin_count; b++)
+			bins[b] = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX }, 0 };
+		float bin_scale = bvh_bin_count * (1 - 1e-5f) / axis_extent;
+		for (uint32_t i = node.start; i < node.start + node.count; i++) {
+			const bvh_prim_t &prim = prims[order[i]];
+			int32_t b = (int32_t)(((&prim.center.x)[axis] - axis_min) * bin_scale);
+			b = b < 0 ? 0 : (b >= bvh_bin_count ? bvh_bin_count - 1 : b);
+			bvh_grow(bins[b].min, bins[b].max, prim.min, prim.max);
+			bins[b].count += 1;
+		}
+
+		// Sweep from both sides to find the cheapest split plane
+		float   left_cost[bvh_bin_count - 1];
+		vec3    acc_min   = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+		vec3    acc_max   = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		int32_t acc_count = 0;
+		for (int32_t b = 0; b < bvh_bin_count - 1; b++) {
+			bvh_grow(acc_min, acc_max, bins[b].min, bins[b].max);
+			acc_count   += bins[b].count;
+			left_cost[b] = acc_count > 0 ? bvh_area(acc_min, acc_max) * acc_count : FLT_MAX;
+		}
+		float   best_cost  = FLT_MAX;
+		int32_t best_split = -1;
+		acc_min   = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+		acc_max   = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		acc_count = 0;
+		for (int32_t b = bvh_bin_count - 1; b > 0; b--) {
+			bvh_grow(acc_min, acc_max, bins[b].min, bins[b].max);
+			acc_count += bins[b].count;
+			if (acc_count == 0 || acc_count == (int32_t)node.count)
+				continue;
+			float cost = left_cost[b-1] + bvh_area(acc_min, acc_max) * acc_count;
+			if (cost < best_cost) {
+				best_cost  = cost;
+				best_split = b;
+			}
+		}
+
+		// Small nodes stay leaves unless splitting them actually pays off
+		float node_area = bvh_area(node.min, node.max);
+		if (best_split < 0 || (node.count <= (uint32_t)bvh_leaf_max && best_cost + node_area * bvh_node_cost >= node_area * node.count))
+			continue;
+
+		mesh_bvh_node_t left  = { {  FLT_MAX,  FLT_MAX,  FLT_MAX }, node.start, { -FLT_MAX, -FLT_MAX, -FLT_MAX }, 0 };
+		mesh_bvh_node_t right = { {  FLT_MAX,  FLT_MAX,  FLT_MAX }, 0,          { -FLT_MAX, -FLT_MAX, -FLT_MAX }, 0 };
+		for (int32_t b = 0; b < bvh_bin_count; b++) {
+			mesh_bvh_node_t &side = b < best_split ? left : right;
+			bvh_grow(side.min, side.max, bins[b].min, bins[b].max);
+			side.count += bins[b].count;
+		}
+		right.start = left.start + left.count;
+
+		// Partition the order to match the bins
+		uint32_t i = node.start;
+		uint32_t j = node.start + node.count;
+		while (i < j) {
+			int32_t b = (int32_t)(((&prims[order[i]].center.x)[axis] - axis_min) * bin_scale);
+			if (b < best_split) {
+				i++;
+			} else {
+				j--;
+				uint32_t tmp = order[i];
+				order[i] = order[j];
+				order[j] = tmp;
+			}
+		}
+
+		nodes[n].start = (uint32_t)nodes.count;
+		nodes[n].count = 0;
+		depth[nodes.count]   = depth[n] + 1;
+		depth[nodes.count+1] = depth[n] + 1;
+		nodes.add(left);
+		nodes.add(right);
+	}
+
+	nodes.resize(nodes.count);
+	out_bvh.nodes      = nodes.data;
+	out_bvh.node_count = nodes.count;
+
+	frame_scratch_release(mark);
+}
+
+///////////////////////////////////////////
+
+void mesh_bvh_build(mesh_collision_t &collision) {
+	int32_t tri_count = collision.tri_count;
+	if (tri_count <= 0)
+		return;
+
+	memory_scope(memory_tag_mesh);
+	frame_mark_t    mark  = frame_scratch_mark();
+	mesh_bvh_box_t *boxes = (mesh_bvh_box_t*)frame_scratch_alloc(sizeof(mesh_bvh_box_t) * tri_count);
+	for (int32_t i = 0; i < tri_count; i++) {
+		const vec3 &p0 = collision.verts[collision.inds[i*3  ]].pos;
+		const vec3 &p1 = collision.verts[collision.inds[i*3+1]].pos;
+		const vec3 &p2 = collision.verts[collision.inds[i*3+2]].pos;
+		boxes[i].min = p0;
+		boxes[i].max = p0;
+		bvh_grow(boxes[i].min, boxes[i].max, p1, p1);
+		bvh_grow(boxes[i].min, boxes[i].max, p2, p2);
+	}
+
+	collision.tris = (uint32_t*)sk_malloc(sizeof(uint32_t) * tri_count);
+	mesh_bvh_build_boxes(boxes, tri_count, collision.bvh, collision.tris);
+	frame_scratch_release(mark);
+}
+
+///////////////////////////////////////////
+
+void mesh_bvh_free(mesh_bvh_t &bvh) {
+	sk_free(bvh.nodes);
+	bvh = {};
+}
+
+///////////////////////////////////////////
+
+// Möller-Trumbore, double sided
+inline bool bvh_ray_triangle(const ray_t &ray, const vec3 &p0, const vec3 &p1, const vec3 &p2, float *out_dist, float *out_u, float *out_v) {
+	vec3  edge1 = p1 - p0;
+	vec3  edge2 = p2 - p0;
+	vec3  p     = vec3_cross(ray.dir, edge2);
+	float det   = vec3_dot(edge1, p);
+	if (fabsf(det) < 1e-20f)
+		return false;
+
+	float inv_det = 1.0f / det;
+	vec3  s       = ray.pos - p0;
+	float u       = vec3_dot(s, p) * inv_det;
+	if (u < 0 || u > 1)
+		return false;
+
+	vec3  q = vec3_cross(s, edge1);
+	float v = vec3_dot(ray.dir, q) * inv_det;
+	if (v < 0 || u + v > 1)
+		return false;
+
+	*out_dist = vec3_dot(edge2, q) * inv_det;
+	*out_u    = u;
+	*out_v    = v;
+	return *out_dist >= 0;
+}
+
+///////////////////////////////////////////
+
+bool32_t mesh_bvh_intersect(const mesh_collision_t &collision, const ray_t &ray, float max_dist, mesh_bvh_hit_t *out_hit) {
+	float nearest = max_dist;
+	bool  hit     = false;
+	mesh_bvh_traverse(collision.bvh, ray, nearest, [&](uint32_t start, uint32_t count) {
+		const vert_t *verts = collision.verts;
+		const vind_t *inds  = collision.inds;
+		float dist, u, v;
+		for (uint32_t i = start; i < start + count; i++) {
+			uint32_t tri = collision.tris[i];
+			if (bvh_ray_triangle(ray, verts[inds[tri*3]].pos, verts[inds[tri*3+1]].pos, verts[inds[tri*3+2]].pos, &dist, &u, &v) && dist < nearest) {
+				nearest  = dist;
+				hit      = true;
+				*out_hit = { dist, tri, u, v };
+			}
+		}
+	});
+	return hit;
+}
+
+///////////////////////////////////////////
+
+inline XMVECTOR bvh_ray4_box(const mesh_bvh_node_t &node, const ray4_t &rays, const XMVECTOR *inv_dir, const XMVECTOR &max_dist) {
+	XMVECTOR t1_x = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.min.x), rays.pos_x), inv_dir[0]);
+	XMVECTOR t1_y = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.min.y), rays.pos_y), inv_dir[1]);
+	XMVECTOR t1_z = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.min.z), rays.pos_z), inv_dir[2]);
+	XMVECTOR t2_x = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.max.x), rays.pos_x), inv_dir[0]);
+	XMVECTOR t2_y = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.max.y), rays.pos_y), inv_dir[1]);
+	XMVECTOR t2_z = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(node.max.z), rays.pos_z), inv_dir[2]);
+
+	XMVECTOR t_near = XMVectorMax(XMVectorMax(XMVectorMin(t1_x, t2_x), XMVectorMin(t1_y, t2_y)), XMVectorMin(t1_z, t2_z));
+	XMVECTOR t_far  = XMVectorMin(XMVectorMin(XMVectorMax(t1_x, t2_x), XMVectorMax(t1_y, t2_y)), XMVectorMax(t1_z, t2_z));
+	return XMVectorAndInt(XMVectorAndInt(
+		XMVectorLessOrEqual   (t_near, t_far),
+		XMVectorGreaterOrEqual(t_far,  XMVectorZero())),
+		XMVectorLess          (t_near, max_dist));
+}
+
+///////////////////////////////////////////
+
+// Möller-Trumbore again, one triangle against four rays. Lanes that hit
+// closer than they've seen so far get their nearest distance updated.
+inline void bvh_ray4_triangle(const ray4_t &rays, const vec3 &p0, const vec3 &p1, const vec3 &p2, XMVECTOR &nearest) {
+	vec3     edge1   = p1 - p0;
+	vec3     edge2   = p2 - p0;
+	XMVECTOR edge1_x = XMVectorReplicate(edge1.x), edge1_y = XMVectorReplicate(edge1.y), edge1_z = XMVectorReplicate(edge1.z);
+	XMVECTOR edge2_x = XMVectorReplicate(edge2.x), edge2_y = XMVectorReplicate(edge2.y), edge2_z = XMVectorReplicate(edge2.z);
+
+	XMVECTOR p_x = XMVectorSubtract(XMVectorMultiply(rays.dir_y, edge2_z), XMVectorMultiply(rays.dir_z, edge2_y));
+	XMVECTOR p_y = XMVectorSubtract(XMVectorMultiply(rays.dir_z, edge2_x), XMVectorMultiply(rays.dir_x, edge2_z));
+	XMVECTOR p_z = XMVectorSubtract(XMVectorMultiply(rays.dir_x, edge2_y), XMVectorMultiply(rays.dir_y, edge2_x));
+	XMVECTOR det = XMVectorMultiplyAdd(edge1_z, p_z, XMVectorMultiplyAdd(edge1_y, p_y, XMVectorMultiply(edge1_x, p_x)));
+	XMVECTOR inv_det = XMVectorReciprocal(det);
+
+	XMVECTOR s_x = XMVectorSubtract(rays.pos_x, XMVectorReplicate(p0.x));
+	XMVECTOR s_y = XMVectorSubtract(rays.pos_y, XMVectorReplicate(p0.y));
+	XMVECTOR s_z = XMVectorSubtract(rays.pos_z, XMVectorReplicate(p0.z));
+	XMVECTOR u   = XMVectorMultiply(XMVectorMultiplyAdd(s_z, p_z, XMVectorMultiplyAdd(s_y, p_y, XMVectorMultiply(s_x, p_x))), inv_det);
+
+	XMVECTOR q_x = XMVectorSubtract(XMVectorMultiply(s_y, edge1_z), XMVectorMultiply(s_z, edge1_y));
+	XMVECTOR q_y = XMVectorSubtract(XMVectorMultiply(s_z, edge1_x), XMVectorMultiply(s_x, edge1_z));
+	XMVECTOR q_z = XMVectorSubtract(XMVectorMultiply(s_x, edge1_y), XMVectorMultiply(s_y, edge1_x));
+	XMVECTOR v   = XMVectorMultiply(XMVectorMultiplyAdd(rays.dir_z, q_z, XMVectorMultiplyAdd(rays.dir_y, q_y, XMVectorMultiply(rays.dir_x, q_x))), inv_det);
+	XMVECTOR t   = XMVectorMultiply(XMVectorMultiplyAdd(edge2_z,   q_z, XMVectorMultiplyAdd(edge2_y,   q_y, XMVectorMultiply(edge2_x,   q_x))), inv_det);
+
+	XMVECTOR zero = XMVectorZero();
+	XMVECTOR one  = XMVectorReplicate(1);
+	XMVECTOR hit  = XMVectorGreaterOrEqual(XMVectorAbs(det), XMVectorReplicate(1e-20f));
+	hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(u, zero));
+	hit = XMVectorAndInt(hit, XMVectorLessOrEqual   (u, one));
+	hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(v, zero));
+	hit = XMVectorAndInt(hit, XMVectorLessOrEqual   (XMVectorAdd(u, v), one));
+	hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(t, zero));
+	hit = XMVectorAndInt(hit, XMVectorLess          (t, nearest));
+	nearest = XMVectorSelect(nearest, t, hit);
+}
+
+///////////////////////////////////////////
+
+void ray_intersect_x4(const mesh_collision_t &collision, const ray_t *rays, vec3 *out_pts, bool32_t *out_hits) {
+	const mesh_bvh_t &bvh = collision.bvh;
+	ray4_t   r       = ray4_load(rays);
+	XMVECTOR nearest = XMVectorReplicate(FLT_MAX);
+
+	if (bvh.node_count > 0) {
+		XMVECTOR tiny       = XMVectorReplicate(1e-20f);
+		XMVECTOR inv_dir[3] = {
+			XMVectorReciprocal(XMVectorSelect(r.dir_x, tiny, XMVectorLess(XMVectorAbs(r.dir_x), tiny))),
+			XMVectorReciprocal(XMVectorSelect(r.dir_y, tiny, XMVectorLess(XMVectorAbs(r.dir_y), tiny))),
+			XMVectorReciprocal(XMVectorSelect(r.dir_z, tiny, XMVectorLess(XMVectorAbs(r.dir_z), tiny))) };
+		// Children get visited in the order the packet is heading, on average
+		vec3 dir_sum = rays[0].dir + rays[1].dir + rays[2].dir + rays[3].dir;
+
+		uint32_t stack[mesh_bvh_max_depth + 4];
+		int32_t  stack_count = 0;
+		stack[stack_count++] = 0;
+		while (stack_count > 0) {
+			const mesh_bvh_node_t &node = bvh.nodes[stack[--stack_count]];
+			if (!XMVector4NotEqualInt(bvh_ray4_box(node, r, inv_dir, nearest), XMVectorFalseInt()))
+				continue;
+
+			if (node.count > 0) {
+				const vert_t *verts = collision.verts;
+				const vind_t *inds  = collision.inds;
+				for (uint32_t i = node.start; i < node.start + node.count; i++) {
+					uint32_t tri = collision.tris[i];
+					bvh_ray4_triangle(r, verts[inds[tri*3]].pos, verts[inds[tri*3+1]].pos, verts[inds[tri*3+2]].pos, nearest);
+				}
+				continue;
+			}
+
+			const mesh_bvh_node_t &a = bvh.nodes[node.start];
+			const mesh_bvh_node_t &b = bvh.nodes[node.start+1];
+			if (vec3_dot((b.min + b.max) - (a.min + a.max), dir_sum) >= 0) {
+				stack[stack_count++] = node.start+1;
+				stack[stack_count++] = node.start;
+			} else {
+				stack[stack_count++] = node.start;
+				stack[stack_count++] = node.start+1;
+			}
+		}
+	}
+
+	XMVECTOR hit = XMVectorLess(nearest, XMVectorReplicate(FLT_MAX));
+	ray4_store_pts (r, nearest, hit, out_pts);
+	ray4_store_hits(hit, out_hits);
+}
+
+///////////////////////////////////////////
+
+bool32_t ray_intersect_x1(const mesh_collision_t &collision, const ray_t &ray, vec3 *out_pt) {
+	mesh_bvh_hit_t hit = {};
+	if (!mesh_bvh_intersect(collision, ray, FLT_MAX, &hit)) {
+		*out_pt = {};
+		return false;
+	}
+	*out_pt = ray.pos + ray.dir * hit.distance;
+	return true;
+}
+
+} // namespace sk
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../stereokit.h"
+#include "../math.h"
+
+#include <float.h>
+#include <math.h>
+
+namespace sk {
+
+// 32 bytes, so two nodes share a cache line. Interior nodes have a count
+// of zero, and their two children sit side by side starting at `start`.
+// Leaves cover `count` entries of the BVH's order list, starting at `start`.
+struct mesh_bvh_node_t {
+	vec3     min;
+	uint32_t start;
+	vec3     max;
+	uint32_t count;
+};
+
+struct mesh_bvh_t {
+	mesh_bvh_node_t *nodes;
+	int32_t          node_count;
+};
+
+struct mesh_bvh_box_t {
+	vec3 min;
+	vec3 max;
+};
+
+// u and v weight the triangle's second and third verts, the first gets the
+// rest. distance is in units of the ray's direction.
+struct mesh_bvh_hit_t {
+	float    distance;
+	uint32_t tri;
+	float    u;
+	float    v;
+};
+
+struct mesh_collision_t;
+
+// Traversal keeps a fixed stack, so the build stops splitting past this
+const int32_t mesh_bvh_max_depth = 60;
+
+// Builds over any list of boxes. out_order needs room for count entries,
+// and gets the box indices in leaf order.
+void     mesh_bvh_build_boxes(const mesh_bvh_box_t *boxes, int32_t count, mesh_bvh_t &out_bvh, uint32_t *out_order);
+void     mesh_bvh_build      (mesh_collision_t &collision);
+void     mesh_bvh_free       (mesh_bvh_t &bvh);
+bool32_t mesh_bvh_intersect  (const mesh_collision_t &collision, const ray_t &ray, float max_dist, mesh_bvh_hit_t *out_hit);
+
+// Batch queries, see ray_batch_run. The four ray version walks the BVH with
+// all four rays together, which pays off when the rays are close together.
+void     ray_intersect_x4(const mesh_collision_t &collision, const ray_t *rays, vec3 *out_pts, bool32_t *out_hits);
+bool32_t ray_intersect_x1(const mesh_collision_t &collision, const ray_t &ray,  vec3 *out_pt);
+
+///////////////////////////////////////////
+
+struct mesh_bvh_ray_t {
+	DirectX::XMVECTOR origin;
+	DirectX::XMVECTOR inv_dir;
+};
+
+inline mesh_bvh_ray_t mesh_bvh_ray(const ray_t &ray) {
+	// Zero direction components would turn into NaNs on the slab test
+	vec3 dir = ray.dir;
+	if (fabsf(dir.x) < 1e-20f) dir.x = 1e-20f;
+	if (fabsf(dir.y) < 1e-20f) dir.y = 1e-20f;
+	if (fabsf(dir.z) < 1e-20f) dir.z = 1e-20f;
+	return { math_vec3_to_fast(ray.pos), DirectX::XMVectorReciprocal(math_vec3_to_fast(dir)) };
+}
+
+///////////////////////////////////////////
+
+inline bool mesh_bvh_ray_box(const mesh_bvh_node_t &node, const mesh_bvh_ray_t &ray, float max_dist, float *out_dist) {
+	using namespace DirectX;
+	XMVECTOR t1    = XMVectorMultiply(XMVectorSubtract(math_vec3_to_fast(node.min), ray.origin), ray.inv_dir);
+	XMVECTOR t2    = XMVectorMultiply(XMVectorSubtract(math_vec3_to_fast(node.max), ray.origin), ray.inv_dir);
+	XMVECTOR t_min = XMVectorMin(t1, t2);
+	XMVECTOR t_max = XMVectorMax(t1, t2);
+	t_min = XMVectorMax(t_min, XMVectorMax(XMVectorSplatY(t_min), XMVectorSplatZ(t_min)));
+	t_max = XMVectorMin(t_max, XMVectorMin(XMVectorSplatY(t_max), XMVectorSplatZ(t_max)));
+
+	float near_dist = XMVectorGetX(t_min);
+	float far_dist  = XMVectorGetX(t_max);
+	*out_dist = near_dist;
+	return near_dist <= far_dist && far_dist >= 0 && near_dist < max_dist;
+}
+
+///////////////////////////////////////////
+
+// Visits the leaves a ray reaches, nearest first, as leaf(start, count).
+// Leaves can lower `nearest` when they find a hit, and anything farther
+// away gets skipped from then on.
+template<typename F>
+void mesh_bvh_traverse(const mesh_bvh_t &bvh, const ray_t &ray, float &nearest, F leaf) {
+	struct stack_t {
+		uint32_t node;
+		float    dist;
+	};
+
+	float          dist = 0;
+	mesh_bvh_ray_t r    = mesh_bvh_ray(ray);
+	if (bvh.node_count == 0 || !mesh_bvh_ray_box(bvh.nodes[0], r, nearest, &dist))
+		return;
+
+	stack_t stack[mesh_bvh_max_depth + 4];
+	int32_t stack_count = 0;
+	stack[stack_count++] = { 0, dist };
+	while (stack_count > 0) {
+		stack_t curr = stack[--stack_count];
+		if (curr.dist >= nearest)
+			continue;
+
+		const mesh_bvh_node_t &node = bvh.nodes[curr.node];
+		if (node.count > 0) {
+			leaf(node.start, node.count);
+			continue;
+		}
+
+		// Push the far child first, so the near one gets visited first and
+		// can cull the far one with its hit.
+		float dist_a, dist_b;
+		bool  hit_a = mesh_bvh_ray_box(bvh.nodes[node.start  ], r, nearest, &dist_a);
+		bool  hit_b = mesh_bvh_ray_box(bvh.nodes[node.start+1], r, nearest, &dist_b);
+		if (hit_a && hit_b) {
+			if (dist_a < dist_b) {
+				stack[stack_count++] = { node.start+1, dist_b };
+				stack[stack_count++] = { node.start,   dist_a };
+			} else {
+				stack[stack_count++] = { node.start,   dist_a };
+				stack[stack_count++] = { node.start+1, dist_b };
+			}
+		} else if (hit_a) {
+			stack[stack_count++] = { node.start, dist_a };
+		} else if (hit_b) {
+			stack[stack_count++] = { node.start+1, dist_b };
+		}
+	}
+}
+
+} // namespace sk
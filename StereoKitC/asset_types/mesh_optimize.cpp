@@ -0,0 +1,272 @@
+#include "mesh_optimize.h"
+#include "../_stereokit.h"
+#include "../systems/frame_alloc.h"
+#include "../math.h"
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct optimize_cluster_t {
+	float   sort;
+	int32_t start;
+	int32_t count;
+};
+
+///////////////////////////////////////////
+
+float mesh_optimize_acmr(const vind_t *inds, int32_t ind_count, int32_t vert_count, int32_t cache_size) {
+	if (ind_count < 3 || vert_count <= 0)
+		return 0;
+
+	// A FIFO cache only changes on a miss, so each vert just needs to know
+	// how many misses ago it went in.
+	frame_mark_t mark  = frame_scratch_mark();
+	int32_t     *stamp = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * vert_count);
+	for (int32_t i = 0; i < vert_count; i++)
+		stamp[i] = -cache_size;
+
+	int32_t misses = 0;
+	for (int32_t i = 0; i < ind_count; i++) {
+		vind_t v = inds[i];
+		if (v >= vert_count) { misses++; continue; }
+		if (misses - stamp[v] >= cache_size) {
+			stamp[v] = misses;
+			misses  += 1;
+		}
+	}
+	frame_scratch_release(mark);
+	return misses / (float)(ind_count / 3);
+}
+
+///////////////////////////////////////////
+
+// Tipsify, from "Fast Triangle Reordering for Vertex Locality and Reduced
+// Overdraw" by Sander, Nehab and Barczak. Fans triangles around one vert at
+// a time, and picks the next vert from the ones that will still be in the
+// cache afterwards. out_clusters gets the first triangle of each run that
+// starts from a cold cache, which is where overdraw sorting can cut.
+void mesh_optimize_tipsify(const vind_t *inds, int32_t ind_count, int32_t vert_count, int32_t cache_size, vind_t *out_inds, int32_t *out_clusters, int32_t *out_cluster_count) {
+	int32_t tri_count = ind_count / 3;
+
+	// Triangles touching each vert, and how many of them are left to emit
+	int32_t *offsets = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * (vert_count + 1));
+	int32_t *live    = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * vert_count);
+	int32_t *cache   = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * vert_count);
+	int32_t *adj     = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * ind_count);
+	int32_t *dead    = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * ind_count);
+	uint8_t *emitted = (uint8_t*)frame_scratch_alloc(sizeof(uint8_t) * tri_count);
+	memset(live,    0, sizeof(int32_t) * vert_count);
+	memset(emitted, 0, sizeof(uint8_t) * tri_count);
+
+	for (int32_t i = 0; i < ind_count; i++)
+		live[inds[i]] += 1;
+	int32_t max_valence = 0;
+	offsets[0] = 0;
+	for (int32_t v = 0; v < vert_count; v++) {
+		offsets[v+1] = offsets[v] + live[v];
+		cache  [v]   = offsets[v];
+		if (max_valence < live[v]) max_valence = live[v];
+	}
+	for (int32_t i = 0; i < ind_count; i++)
+		adj[cache[inds[i]]++] = i / 3;
+	memset(cache, 0, sizeof(int32_t) * vert_count);
+
+	int32_t *candidates = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * max_valence * 3);
+	int32_t  dead_count = 0;
+	int32_t  scan       = 0;
+	int32_t  time       = cache_size + 1;
+	int32_t  out        = 0;
+	int32_t  clusters   = 0;
+
+	// Falls back on recently used verts, then on the first vert with
+	// triangles left, when the fan didn't leave any good candidates.
+	auto skip_dead_end = [&]() {
+		while (dead_count > 0) {
+			int32_t v = dead[--dead_count];
+			if (live[v] > 0) return v;
+		}
+		while (scan < vert_count) {
+			if (live[scan] > 0) return scan;
+			scan++;
+		}
+		return -1;
+	};
+
+	int32_t fan = skip_dead_end();
+	if (fan >= 0)
+		out_clusters[clusters++] = 0;
+	while (fan >= 0) {
+		int32_t candidate_count = 0;
+		for (int32_t a = offsets[fan]; a < offsets[fan+1]; a++) {
+			int32_t tri = adj[a];
+			if (emitted[tri]) continue;
+			emitted[tri] = 1;
+
+			for (int32_t c = 0; c < 3; c++) {
+				vind_t v = inds[tri*3 + c];
+				out_inds  [out++]             = v;
+				dead      [dead_count++]      = v;
+				candidates[candidate_count++] = v;
+				live[v] -= 1;
+				if (time - cache[v] > cache_size) {
+					cache[v] = time;
+					time    += 1;
+				}
+			}
+		}
+
+		// Prefer the candidate that's been in the cache longest, as long as
+		// its own fan won't push it out of the cache.
+		int32_t next     = -1;
+		int32_t priority = -1;
+		for (int32_t i = 0; i < candidate_count; i++) {
+			int32_t v = candidates[i];
+			if (live[v] <= 0) continue;
+			int32_t p = 0;
+			if (time - cache[v] + 2 * live[v] <= cache_size)
+				p = time - cache[v];
+			if (p > priority) {
+				priority = p;
+				next     = v;
+			}
+		}
+		if (next == -1) {
+			next = skip_dead_end();
+			if (next >= 0 && time - cache[next] > cache_size)
+				out_clusters[clusters++] = out / 3;
+		}
+		fan = next;
+	}
+	*out_cluster_count = clusters;
+}
+
+///////////////////////////////////////////
+
+// Draws clusters that face away from the middle of the mesh first, since
+// those are the ones most likely to cover everything else. Each cluster
+// keeps its own triangle order, so the cache work mostly survives.
+void mesh_optimize_overdraw(const vert_t *verts, vind_t *inds, int32_t ind_count, const int32_t *cluster_starts, int32_t cluster_count) {
+	optimize_cluster_t *clusters = (optimize_cluster_t*)frame_scratch_alloc(sizeof(optimize_cluster_t) * cluster_count);
+	vec3               *centers  = (vec3              *)frame_scratch_alloc(sizeof(vec3)               * cluster_count);
+	vec3               *normals  = (vec3              *)frame_scratch_alloc(sizeof(vec3)               * cluster_count);
+
+	// Area weighted, so big faces count for more than slivers
+	vec3  mesh_center = vec3_zero;
+	float mesh_area   = 0;
+	for (int32_t c = 0; c < cluster_count; c++) {
+		int32_t start = cluster_starts[c];
+		int32_t end   = c+1 < cluster_count ? cluster_starts[c+1] : ind_count / 3;
+		vec3    center = vec3_zero;
+		vec3    normal = vec3_zero;
+		float   area   = 0;
+		for (int32_t t = start; t < end; t++) {
+			vec3  a = verts[inds[t*3  ]].pos;
+			vec3  b = verts[inds[t*3+1]].pos;
+			vec3  d = verts[inds[t*3+2]].pos;
+			vec3  n = vec3_cross(b - a, d - a);
+			float w = vec3_magnitude(n);
+			center  = center + (a + b + d) * (w / 3.0f);
+			normal  = normal + n;
+			area   += w;
+		}
+		mesh_center = mesh_center + center;
+		mesh_area  += area;
+		centers [c] = area > 0 ? center / area : verts[inds[start*3]].pos;
+		normals [c] = normal;
+		clusters[c] = { 0, start, end - start };
+	}
+	if (mesh_area > 0)
+		mesh_center = mesh_center / mesh_area;
+
+	for (int32_t c = 0; c < cluster_count; c++) {
+		float length = vec3_magnitude(normals[c]);
+		clusters[c].sort = length > 0
+			? vec3_dot(centers[c] - mesh_center, normals[c]) / length
+			: 0;
+	}
+	std::stable_sort(clusters, clusters + cluster_count, [](const optimize_cluster_t &a, const optimize_cluster_t &b) {
+		return a.sort > b.sort; });
+
+	vind_t *sorted = (vind_t*)frame_scratch_alloc(sizeof(vind_t) * ind_count);
+	int32_t curr   = 0;
+	for (int32_t c = 0; c < cluster_count; c++) {
+		memcpy(&sorted[curr], &inds[clusters[c].start * 3], sizeof(vind_t) * clusters[c].count * 3);
+		curr += clusters[c].count * 3;
+	}
+	memcpy(inds, sorted, sizeof(vind_t) * ind_count);
+}
+
+///////////////////////////////////////////
+
+// Puts verts in the order the triangles first use them, so the vertex
+// fetches walk through memory instead of jumping around. Verts no triangle
+// uses go to the end.
+void mesh_optimize_fetch(vert_t *verts, int32_t vert_count, vind_t *inds, int32_t ind_count) {
+	int32_t *remap  = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * vert_count);
+	vert_t  *source = (vert_t *)frame_scratch_alloc(sizeof(vert_t)  * vert_count);
+	memcpy(source, verts, sizeof(vert_t) * vert_count);
+	for (int32_t i = 0; i < vert_count; i++)
+		remap[i] = -1;
+
+	int32_t next = 0;
+	for (int32_t i = 0; i < ind_count; i++) {
+		if (remap[inds[i]] == -1)
+			remap[inds[i]] = next++;
+		inds[i] = (vind_t)remap[inds[i]];
+	}
+	for (int32_t i = 0; i < vert_count; i++) {
+		if (remap[i] == -1)
+			remap[i] = next++;
+		verts[remap[i]] = source[i];
+	}
+}
+
+///////////////////////////////////////////
+
+bool mesh_optimize_data(vert_t *verts, int32_t vert_count, vind_t *inds, int32_t ind_count, bool overdraw) {
+	if (ind_count < 3 || vert_count <= 0 || ind_count % 3 != 0)
+		return false;
+	for (int32_t i = 0; i < ind_count; i++) {
+		if (inds[i] >= vert_count)
+			return false;
+	}
+
+	frame_mark_t mark          = frame_scratch_mark();
+	vind_t      *ordered       = (vind_t *)frame_scratch_alloc(sizeof(vind_t)  * ind_count);
+	int32_t     *clusters      = (int32_t*)frame_scratch_alloc(sizeof(int32_t) * (ind_count / 3));
+	int32_t      cluster_count = 0;
+	mesh_optimize_tipsify(inds, ind_count, vert_count, mesh_optimize_cache_size, ordered, clusters, &cluster_count);
+	memcpy(inds, ordered, sizeof(vind_t) * ind_count);
+
+	if (overdraw && cluster_count > 1)
+		mesh_optimize_overdraw(verts, inds, ind_count, clusters, cluster_count);
+	mesh_optimize_fetch(verts, vert_count, inds, ind_count);
+
+	frame_scratch_release(mark);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void mesh_optimize_import(const char *id, vert_t *verts, int32_t vert_count, vind_t *inds, int32_t ind_count) {
+#ifndef SK_NO_MESH_OPTIMIZE
+	if (sk_settings.disable_mesh_optimize)
+		return;
+
+	float before = mesh_optimize_acmr(inds, ind_count, vert_count);
+	if (!mesh_optimize_data(verts, vert_count, inds, ind_count, false)) {
+		if (ind_count >= 3)
+			log_warnf("mesh_optimize: %s has bad indices, leaving it unoptimized", id);
+		return;
+	}
+	float after = mesh_optimize_acmr(inds, ind_count, vert_count);
+	log_diagf("mesh_optimize: %s, %d tris, ACMR %.3f -> %.3f", id, ind_count / 3, before, after);
+#endif
+}
+
+} // namespace sk
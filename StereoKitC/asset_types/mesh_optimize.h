@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../stereokit.h"
+
+namespace sk {
+
+// Post-transform cache size the triangle order is tuned for. Real hardware
+// varies a lot here, but orders made for a small cache hold up well on
+// bigger ones.
+const int32_t mesh_optimize_cache_size = 16;
+
+// Average cache misses per triangle, simulated with a FIFO cache. 3 is the
+// worst possible, and well ordered meshes land around 0.6-0.7.
+float mesh_optimize_acmr(const vind_t *inds, int32_t ind_count, int32_t vert_count, int32_t cache_size = mesh_optimize_cache_size);
+
+// Reorders triangles for the vertex cache, optionally sorts the resulting
+// clusters to cut down on overdraw, then reorders the verts in the order
+// the triangles first use them. Works in place, and leaves the vertex and
+// index counts the same. Returns false if the indices don't fit the verts.
+bool  mesh_optimize_data  (vert_t *verts, int32_t vert_count, vind_t *inds, int32_t ind_count, bool overdraw);
+
+// For the model importers, optimizes and logs the ACMR before and after.
+// Does nothing when built with SK_NO_MESH_OPTIMIZE, or when
+// settings_t.disable_mesh_optimize is set.
+void  mesh_optimize_import(const char *id, vert_t *verts, int32_t vert_count, vind_t *inds, int32_t ind_count);
+
+} // namespace sk
@@ -7,9 +7,15 @@
 #include "texture.h"
 #include "../libraries/stref.h"
 #include "../systems/platform/platform_utils.h"
+#include "../systems/profiler.h"
+#include "../systems/memory_track.h"
+#include "../systems/frame_alloc.h"
 
 #include <stdio.h>
 
+#include <directxmath.h> // Matrix math functions and objects
+using namespace DirectX;
+
 namespace sk {
 
 ///////////////////////////////////////////
@@ -77,6 +83,7 @@ model_t model_create_file(const char *filename, shader_t shader) {
 	model_t result = model_find(filename);
 	if (result != nullptr)
 		return result;
+	profile_zone("model_create_file");
 
 	void  *data;
 	size_t length;
@@ -94,31 +101,148 @@ model_t model_create_file(const char *filename, shader_t shader) {
 
 ///////////////////////////////////////////
 
+void model_subset_bounds(const model_subset_t &subset, vec3 &min, vec3 &max) {
+	// Find the corners of the mesh's bounding cube, and factor them in!
+	for (int32_t i = 0; i < 8; i += 1) {
+		vec3 corner = bounds_corner   (subset.mesh->bounds, i);
+		vec3 pt     = matrix_mul_point(subset.offset, corner);
+		min.x = fminf(pt.x, min.x);
+		min.y = fminf(pt.y, min.y);
+		min.z = fminf(pt.z, min.z);
+
+		max.x = fmaxf(pt.x, max.x);
+		max.y = fmaxf(pt.y, max.y);
+		max.z = fmaxf(pt.z, max.z);
+	}
+}
+
+///////////////////////////////////////////
+
+uint64_t model_lod_key(model_t model, const vec3 &position) {
+	// Cells about the size of the model, so a moving object keeps its key
+	// for a while, and two separate objects rarely end up sharing one.
+	vec3    size = model->bounds.dimensions;
+	float   cell = fmaxf(0.01f, fmaxf(size.x, fmaxf(size.y, size.z)));
+	int64_t x    = (int64_t)floorf(position.x / cell);
+	int64_t y    = (int64_t)floorf(position.y / cell);
+	int64_t z    = (int64_t)floorf(position.z / cell);
+	uint64_t key = ((uint64_t)x * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)y * 0xC2B2AE3D27D4EB4Full) ^ ((uint64_t)z * 0x165667B19E3779F9ull);
+	return key == 0 ? 1 : key; // 0 marks an empty slot
+}
+
+///////////////////////////////////////////
+
+int32_t model_lod_slot(const model_lod_table_t &table, uint64_t key) {
+	int32_t mask = table.capacity - 1;
+	int32_t slot = (int32_t)((key ^ (key >> 32)) & mask);
+	while (table.keys[slot] != 0 && table.keys[slot] != key)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+///////////////////////////////////////////
+
+void model_lod_table_free(model_lod_table_t &table) {
+	sk_free(table.keys);
+	sk_free(table.levels);
+	table = {};
+}
+
+///////////////////////////////////////////
+
+void model_lod_table_grow(model_lod_table_t &table, int32_t stride) {
+	if ((table.count + 1) * 2 <= table.capacity)
+		return;
+
+	model_lod_table_t result = {};
+	result.capacity = table.capacity > 0 ? table.capacity * 2 : 16;
+	result.keys     = (uint64_t*)sk_calloc(result.capacity, sizeof(uint64_t));
+	result.levels   = (uint8_t *)sk_malloc(result.capacity * stride);
+	result.count    = table.count;
+	for (int32_t i = 0; i < table.capacity; i++) {
+		if (table.keys[i] == 0) continue;
+		int32_t slot = model_lod_slot(result, table.keys[i]);
+		result.keys[slot] = table.keys[i];
+		memcpy(&result.levels[slot * stride], &table.levels[i * stride], stride);
+	}
+	model_lod_table_free(table);
+	table = result;
+}
+
+///////////////////////////////////////////
+
+uint8_t *model_lod_state(model_t model, uint64_t frame, const vec3 &position) {
+	memory_scope(memory_tag_model);
+	if (model->lod_stride != model->subset_count) {
+		model_lod_free(model);
+		model->lod_stride = model->subset_count;
+	}
+
+	// lod_tables[0] is this frame, and [1] is the frame before. Anything
+	// older than that is too old to be worth matching against.
+	if (model->lod_frame != frame) {
+		model_lod_table_t last = model->lod_tables[0];
+		model->lod_tables[0] = model->lod_tables[1];
+		model->lod_tables[1] = last;
+		if (model->lod_frame + 1 != frame)
+			model_lod_table_free(model->lod_tables[1]);
+		if (model->lod_tables[0].capacity > 0) {
+			memset(model->lod_tables[0].keys, 0, sizeof(uint64_t) * model->lod_tables[0].capacity);
+			model->lod_tables[0].count = 0;
+		}
+		model->lod_frame = frame;
+	}
+
+	int32_t            stride = model->lod_stride;
+	uint64_t           key    = model_lod_key(model, position);
+	model_lod_table_t &curr   = model->lod_tables[0];
+	model_lod_table_t &prev   = model->lod_tables[1];
+	model_lod_table_grow(curr, stride);
+	int32_t  slot   = model_lod_slot(curr, key);
+	uint8_t *levels = &curr.levels[slot * stride];
+	if (curr.keys[slot] != key) {
+		curr.keys[slot] = key;
+		curr.count     += 1;
+
+		int32_t last = prev.capacity > 0 ? model_lod_slot(prev, key) : -1;
+		if (last >= 0 && prev.keys[last] == key) memcpy(levels, &prev.levels[last * stride], stride);
+		else                                      memset(levels, model_lod_none, stride);
+	}
+	return levels;
+}
+
+///////////////////////////////////////////
+
+void model_lod_free(model_t model) {
+	model_lod_table_free(model->lod_tables[0]);
+	model_lod_table_free(model->lod_tables[1]);
+}
+
+///////////////////////////////////////////
+
+void model_ray_free(model_t model) {
+	mesh_bvh_free(model->ray_bvh);
+	sk_free(model->ray_order);
+	sk_free(model->ray_inv_offsets);
+	sk_free(model->ray_generations);
+	model->ray_order       = nullptr;
+	model->ray_inv_offsets = nullptr;
+	model->ray_generations = nullptr;
+}
+
+///////////////////////////////////////////
+
 void model_recalculate_bounds(model_t model) {
+	model_ray_free(model);
 	if (model->subset_count <= 0) {
 		model->bounds = {};
 		return;
 	}
 
-	// Get an initial size
-	vec3 first_corner = bounds_corner(model->subsets[0].mesh->bounds, 0);
-	vec3 min, max;
-	min = max = matrix_mul_point( model->subsets[0].offset, first_corner);
-	
-	// Find the corners for each bounding cube, and factor them in!
-	for (int32_t m = 0; m < model->subset_count; m += 1) {
-		for (int32_t i = 0; i < 8; i += 1) {
-			vec3 corner = bounds_corner   (model->subsets[m].mesh->bounds, i);
-			vec3 pt     = matrix_mul_point(model->subsets[m].offset, corner);
-			min.x = fminf(pt.x, min.x);
-			min.y = fminf(pt.y, min.y);
-			min.z = fminf(pt.z, min.z);
-
-			max.x = fmaxf(pt.x, max.x);
-			max.y = fmaxf(pt.y, max.y);
-			max.z = fmaxf(pt.z, max.z);
-		}
-	}
+	vec3 min = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+	vec3 max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (int32_t m = 0; m < model->subset_count; m += 1)
+		model_subset_bounds(model->subsets[m], min, max);
 	
 	// Final bounds value
 	model->bounds = bounds_t{ min / 2 + max / 2, max - min };
@@ -176,6 +300,7 @@ void model_set_mesh(model_t model, int32_t subset, mesh_t mesh) {
 void model_set_transform(model_t model, int32_t subset, const matrix &transform) {
 	assert(subset < model->subset_count);
 	model->subsets[subset].offset = transform;
+	model_ray_free(model);
 }
 ///////////////////////////////////////////
 
@@ -190,7 +315,8 @@ int32_t model_add_subset(model_t model, mesh_t mesh, material_t material, const
 	assert(mesh     != nullptr);
 	assert(material != nullptr);
 
-	model->subsets                      = (model_subset_t *)realloc(model->subsets, sizeof(model_subset_t) * (model->subset_count + 1));
+	memory_scope(memory_tag_model);
+	model->subsets                      = (model_subset_t *)sk_realloc(model->subsets, sizeof(model_subset_t) * (model->subset_count + 1));
 	model->subsets[model->subset_count] = model_subset_t{ mesh, material, transform };
 	assets_addref(mesh->header);
 	assets_addref(material->header);
@@ -208,6 +334,9 @@ void model_remove_subset(model_t model, int32_t subset) {
 
 	mesh_release    (model->subsets[subset].mesh);
 	material_release(model->subsets[subset].material);
+	for (int32_t i = 0; i < model->subsets[subset].lod_count; i++)
+		mesh_release(model->subsets[subset].lods[i].mesh);
+	sk_free(model->subsets[subset].lods);
 	if (subset < model->subset_count - 1) {
 		memmove(
 			&model->subsets[subset],
@@ -215,6 +344,131 @@ void model_remove_subset(model_t model, int32_t subset) {
 			sizeof(model_subset_t) * (model->subset_count - (subset + 1)));
 	}
 	model->subset_count -= 1;
+	model_ray_free(model);
+}
+
+///////////////////////////////////////////
+
+int32_t model_add_lod(model_t model, int32_t subset, mesh_t mesh, float max_screen_size) {
+	assert(subset < model->subset_count);
+	assert(mesh != nullptr);
+
+	model_subset_t &sub = model->subsets[subset];
+	if (sub.lod_count >= 255) {
+		log_err("model_add_lod: Too many LOD levels on this subset!");
+		return -1;
+	}
+
+	// Keep the levels ordered from most to least detailed
+	int32_t at = 0;
+	while (at < sub.lod_count && sub.lods[at].screen_size >= max_screen_size)
+		at++;
+
+	memory_scope(memory_tag_model);
+	sub.lods = (model_lod_t*)sk_realloc(sub.lods, sizeof(model_lod_t) * (sub.lod_count + 1));
+	if (at < sub.lod_count)
+		memmove(&sub.lods[at + 1], &sub.lods[at], sizeof(model_lod_t) * (sub.lod_count - at));
+	sub.lods[at] = model_lod_t{ mesh, max_screen_size };
+	sub.lod_count += 1;
+	assets_addref(mesh->header);
+
+	model->has_lods = true;
+	return at + 1;
+}
+
+///////////////////////////////////////////
+
+void model_optimize(model_t model) {
+#ifdef SK_32BIT_INDICES
+	const int32_t max_verts = 0x7FFFFFFF;
+#else
+	const int32_t max_verts = 0xFFFF + 1;
+#endif
+
+	// Subsets with LODs or without CPU side mesh data can't be merged, so
+	// those are just carried over as-is.
+	frame_mark_t mark = frame_scratch_mark();
+	bool32_t    *done = (bool32_t*)frame_scratch_alloc(sizeof(bool32_t) * model->subset_count);
+	for (int32_t i = 0; i < model->subset_count; i++) {
+		const model_subset_t &sub = model->subsets[i];
+		done[i] = sub.lod_count > 0 || sub.mesh->verts == nullptr || sub.mesh->inds == nullptr;
+	}
+
+	memory_scope(memory_tag_model);
+	array_t<model_subset_t> result = {};
+	array_t<vert_t>         verts  = {};
+	array_t<vind_t>         inds   = {};
+	for (int32_t i = 0; i < model->subset_count; i++) {
+		int32_t shared = 0;
+		for (int32_t j = i; !done[i] && j < model->subset_count; j++) {
+			if (!done[j] && model->subsets[j].material == model->subsets[i].material)
+				shared += 1;
+		}
+		if (done[i] || shared == 1) {
+			result.add(model->subsets[i]);
+			done[i] = true;
+			continue;
+		}
+
+		// Bake every subset with this material into as few meshes as the
+		// index format allows. Hold onto the material while we release
+		// the old subsets.
+		material_t material = model->subsets[i].material;
+		assets_addref(material->header);
+		verts.clear();
+		inds .clear();
+		for (int32_t j = i; j < model->subset_count; j++) {
+			model_subset_t &sub = model->subsets[j];
+			if (done[j] || sub.material != material)
+				continue;
+			done[j] = true;
+
+			mesh_t mesh = sub.mesh;
+			if (verts.count + mesh->vert_count > max_verts) {
+				mesh_t merged = mesh_create();
+				mesh_set_verts(merged, verts.data, verts.count);
+				mesh_set_inds (merged, inds .data, inds .count);
+				result.add(model_subset_t{ merged, material, matrix_identity });
+				assets_addref(material->header);
+				verts.clear();
+				inds .clear();
+			}
+
+			XMMATRIX offset, normal_tr;
+			math_matrix_to_fast(sub.offset, &offset);
+			normal_tr = XMMatrixTranspose(XMMatrixInverse(nullptr, offset));
+
+			vind_t start = (vind_t)verts.count;
+			for (int32_t v = 0; v < mesh->vert_count; v++) {
+				vert_t vert = mesh->verts[v];
+				XMStoreFloat3((XMFLOAT3*)&vert.pos,  XMVector3Transform                 (XMLoadFloat3((XMFLOAT3*)&vert.pos ), offset));
+				XMStoreFloat3((XMFLOAT3*)&vert.norm, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3((XMFLOAT3*)&vert.norm), normal_tr)));
+				verts.add(vert);
+			}
+			for (int32_t n = 0; n < mesh->ind_count; n++) {
+				inds.add((vind_t)(start + mesh->inds[n]));
+			}
+
+			mesh_release    (sub.mesh);
+			material_release(sub.material);
+		}
+
+		mesh_t merged = mesh_create();
+		mesh_set_verts(merged, verts.data, verts.count);
+		mesh_set_inds (merged, inds .data, inds .count);
+		result.add(model_subset_t{ merged, material, matrix_identity });
+	}
+
+	// The result array's memory becomes the new subset list
+	sk_free(model->subsets);
+	model->subsets      = result.data;
+	model->subset_count = result.count;
+	model_lod_free(model);
+	verts.free();
+	inds .free();
+	frame_scratch_release(mark);
+
+	model_recalculate_bounds(model);
 }
 
 ///////////////////////////////////////////
@@ -240,12 +494,79 @@ bounds_t model_get_bounds(model_t model) {
 
 ///////////////////////////////////////////
 
+void model_ray_build(model_t model) {
+	memory_scope(memory_tag_model);
+	frame_mark_t    mark  = frame_scratch_mark();
+	mesh_bvh_box_t *boxes = (mesh_bvh_box_t*)frame_scratch_alloc(sizeof(mesh_bvh_box_t) * model->subset_count);
+	model->ray_order       = (uint32_t*)sk_malloc(sizeof(uint32_t) * model->subset_count);
+	model->ray_inv_offsets = (matrix  *)sk_malloc(sizeof(matrix)   * model->subset_count);
+	model->ray_generations = (uint32_t*)sk_malloc(sizeof(uint32_t) * model->subset_count);
+	for (int32_t i = 0; i < model->subset_count; i++) {
+		boxes[i] = { {  FLT_MAX,  FLT_MAX,  FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+		model_subset_bounds(model->subsets[i], boxes[i].min, boxes[i].max);
+		matrix_inverse(model->subsets[i].offset, model->ray_inv_offsets[i]);
+		model->ray_generations[i] = model->subsets[i].mesh->generation;
+	}
+	mesh_bvh_build_boxes(boxes, model->subset_count, model->ray_bvh, model->ray_order);
+	frame_scratch_release(mark);
+}
+
+///////////////////////////////////////////
+
+bool32_t model_ray_intersect(model_t model, ray_t model_space_ray, model_hit_t *out_hit) {
+	if (model->subset_count <= 0)
+		return false;
+	for (int32_t i = 0; model->ray_order != nullptr && i < model->subset_count; i++) {
+		if (model->ray_generations[i] != model->subsets[i].mesh->generation)
+			model_ray_free(model);
+	}
+	if (model->ray_order == nullptr)
+		model_ray_build(model);
+
+	float          nearest    = FLT_MAX;
+	mesh_bvh_hit_t hit        = {};
+	int32_t        hit_subset = -1;
+	mesh_bvh_traverse(model->ray_bvh, model_space_ray, nearest, [&](uint32_t start, uint32_t count) {
+		for (uint32_t i = start; i < start + count; i++) {
+			int32_t                 subset = (int32_t)model->ray_order[i];
+			const mesh_collision_t *data   = mesh_get_collision_data(model->subsets[subset].mesh);
+			if (data == nullptr)
+				continue;
+
+			// Leaving the direction unnormalized keeps distances along the
+			// ray comparable between subsets.
+			const matrix &inv   = model->ray_inv_offsets[subset];
+			ray_t         local = { matrix_mul_point(inv, model_space_ray.pos), matrix_mul_direction(inv, model_space_ray.dir) };
+			if (mesh_bvh_intersect(*data, local, nearest, &hit)) {
+				nearest    = hit.distance;
+				hit_subset = subset;
+			}
+		}
+	});
+	if (hit_subset < 0)
+		return false;
+
+	out_hit->pt          = model_space_ray.pos + model_space_ray.dir * nearest;
+	out_hit->distance    = nearest;
+	out_hit->subset      = hit_subset;
+	out_hit->triangle    = (int32_t)hit.tri;
+	out_hit->barycentric = { 1 - hit.u - hit.v, hit.u, hit.v };
+	return true;
+}
+
+///////////////////////////////////////////
+
 void model_destroy(model_t model) {
 	for (size_t i = 0; i < model->subset_count; i++) {
 		mesh_release    (model->subsets[i].mesh);
 		material_release(model->subsets[i].material);
+		for (int32_t l = 0; l < model->subsets[i].lod_count; l++)
+			mesh_release(model->subsets[i].lods[l].mesh);
+		sk_free(model->subsets[i].lods);
 	}
-	free(model->subsets);
+	sk_free(model->subsets);
+	model_lod_free(model);
+	model_ray_free(model);
 	*model = {};
 }
 
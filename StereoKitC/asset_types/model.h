@@ -2,26 +2,66 @@
 
 #include "../stereokit.h"
 #include "assets.h"
+#include "mesh_bvh.h"
+#include "../libraries/array.h"
 
 namespace sk {
 
+// A lower detail mesh for a subset, used once the subset covers less than
+// screen_size of the view's height.
+struct model_lod_t {
+	mesh_t mesh;
+	float  screen_size;
+};
+
+// One frame's worth of LOD levels for a model's draws, keyed by where each
+// draw was. An open addressed hash table, with subset_count levels per slot.
+struct model_lod_table_t {
+	uint64_t *keys;
+	uint8_t  *levels;
+	int32_t   capacity;
+	int32_t   count;
+};
+
+const uint8_t model_lod_none = 0xFF;
+
 struct model_subset_t {
-	mesh_t      mesh;
-	material_t  material;
-	matrix      offset;
+	mesh_t       mesh;
+	material_t   material;
+	matrix       offset;
+	model_lod_t *lods;
+	int32_t      lod_count;
 };
 
 struct _model_t {
-	asset_header_t  header;
-	model_subset_t *subsets;
-	int             subset_count;
-	bounds_t        bounds;
+	asset_header_t    header;
+	model_subset_t   *subsets;
+	int               subset_count;
+	bounds_t          bounds;
+
+	// The LOD level each subset had the last time it was drawn, for
+	// hysteresis. Draws find last frame's levels by position, so it doesn't
+	// matter what order the model gets drawn in.
+	bool32_t          has_lods;
+	model_lod_table_t lod_tables[2];
+	int32_t           lod_stride;
+	uint64_t          lod_frame;
+
+	// A BVH over the subset bounds, built the first time the model gets
+	// ray cast, and dropped whenever the subsets change. The subset mesh
+	// generations catch meshes that were edited after the build.
+	mesh_bvh_t        ray_bvh;
+	uint32_t         *ray_order;
+	matrix           *ray_inv_offsets;
+	uint32_t         *ray_generations;
 };
 
 bool modelfmt_fbx (model_t model, const char *filename, void *file_data, size_t file_size, shader_t shader);
 bool modelfmt_obj (model_t model, const char *filename, void *file_data, size_t file_size, shader_t shader);
 bool modelfmt_gltf(model_t model, const char *filename, void *file_data, size_t file_size, shader_t shader);
 bool modelfmt_stl (model_t model, const char *filename, void *file_data, size_t file_size, shader_t shader);
-void model_destroy(model_t model);
+uint8_t *model_lod_state(model_t model, uint64_t frame, const vec3 &position);
+void     model_lod_free (model_t model);
+void     model_destroy  (model_t model);
 
 } // namespace sk
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "../stereokit.h"
 #include "model.h"
+#include "mesh_optimize.h"
 #include "../libraries/miniz.h"
 #include "../libraries/ofbx.h"
 #include "../libraries/stref.h"
@@ -123,6 +124,7 @@ mesh_t modelfmt_fbx_geometry(const char *filename, const char *folder, const cha
 	}
 
 	// Assemble a mesh
+	mesh_optimize_import(id, verts, vert_count, inds, ind_count);
 	result = mesh_create();
 	mesh_set_id   (result, id);
 	mesh_set_verts(result, verts, vert_count);
@@ -1,6 +1,7 @@
 #define _CRT_SECURE_NO_WARNINGS 1
 
 #include "model.h"
+#include "mesh_optimize.h"
 #include "texture.h"
 
 #include <math.h>
@@ -92,6 +93,7 @@ mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, const char *filename) {
 		}
 	}
 
+	mesh_optimize_import(id, verts, vert_count, inds, ind_count);
 	result = mesh_create();
 	mesh_set_id   (result, id);
 	mesh_set_verts(result, verts, vert_count);
@@ -1,4 +1,5 @@
 #include "model.h"
+#include "mesh_optimize.h"
 #include "../libraries/stref.h"
 #include "../libraries/stb_ds.h"
 
@@ -99,6 +100,7 @@ bool modelfmt_obj(model_t model, const char *filename, void *file_data, size_t,
 
 	char id[512];
 	sprintf_s(id, 512, "%s/mesh", filename);
+	mesh_optimize_import(id, &verts[0], (int)arrlen(verts), &faces[0], (int)arrlen(faces));
 	mesh_t mesh = mesh_create();
 	mesh_set_id   (mesh, id);
 	mesh_set_verts(mesh, &verts[0], (int)arrlen(verts));
@@ -3,6 +3,7 @@
 #include "../libraries/stref.h"
 #include "../systems/d3d.h"
 #include "../systems/platform/platform_utils.h"
+#include "../systems/profiler.h"
 #include "../shaders_builtin/shader_builtin_include.h"
 #include "shader.h"
 #include "shader_file.h"
@@ -242,6 +243,7 @@ shader_t shader_create_file(const char *filename) {
 	shader_t result = shader_find(filename);
 	if (result != nullptr)
 		return result;
+	profile_zone("shader_create_file");
 
 	// Load from file
 	void  *data;
@@ -1,5 +1,6 @@
 #include "../stereokit.h"
 #include "../asset_types/assets.h"
+#include "../systems/memory_track.h"
 #include "sound.h"
 
 #define DR_WAV_IMPLEMENTATION
@@ -19,6 +20,8 @@ matrix       au_head_transform;
 ma_decoder_config au_decoder_config = {};
 ma_device_config  au_config = {};
 ma_device         au_device = {};
+ma_context        au_context = {};
+bool              au_context_used = false;
 #ifdef _MSC_VER
 IsacAdapter* isac_adapter = nullptr;
 #endif
@@ -69,7 +72,10 @@ sound_t sound_generate(float (*function)(float), float duration) {
     sound_t result = (_sound_t*)assets_allocate(asset_type_sound);
 
     au_decoder_config = ma_decoder_config_init(SAMPLE_FORMAT, CHANNEL_COUNT, SAMPLE_RATE);
-    result->sound_data = malloc(sizeof(float) * (size_t)(duration * SAMPLE_RATE));
+    {
+        memory_scope(memory_tag_sound);
+        result->sound_data = sk_malloc(sizeof(float) * (size_t)(duration * SAMPLE_RATE));
+    }
     float *data = (float*)result->sound_data;
     for (uint32_t i = 0, s = (size_t)(duration * SAMPLE_RATE); i < s; i += 1) {
         data[i] = function((float)i / (float)SAMPLE_RATE);
@@ -78,7 +84,7 @@ sound_t sound_generate(float (*function)(float), float duration) {
     au_decoder_config = ma_decoder_config_init(SAMPLE_FORMAT, CHANNEL_COUNT, SAMPLE_RATE);
     if (ma_decoder_init_memory_raw(result->sound_data, sizeof(float) * (size_t)(duration * SAMPLE_RATE), &au_decoder_config, &au_decoder_config, &result->decoder) != MA_SUCCESS) {
         log_err("Failed to generate sound!");
-        free(result->sound_data);
+        sk_free(result->sound_data);
         return nullptr;
     }
     return result;
@@ -118,7 +124,7 @@ void sound_release(sound_t sound) {
 
 void sound_destroy(sound_t sound) {
     ma_decoder_uninit(&sound->decoder);
-    free(sound->sound_data);
+    sk_free(sound->sound_data);
     memset(sound, 0, sizeof(_sound_t));
 }
 
@@ -241,13 +247,31 @@ void isac_data_callback(float** sourceBuffers, uint32_t numSources, uint32_t num
 ///////////////////////////////////////////
 
 bool sound_init() {
+    // Headless runs still mix sound, but into a null device, since the
+    // machines they run on often don't have any audio hardware.
+    bool headless = sk_active_runtime() == runtime_headless;
+
 #ifdef _MSC_VER
-    isac_adapter = new IsacAdapter(_countof(au_active_sounds));
-    HRESULT hr = isac_adapter->Activate(isac_data_callback);
+    HRESULT hr = E_FAIL;
+    if (!headless) {
+        isac_adapter = new IsacAdapter(_countof(au_active_sounds));
+        hr = isac_adapter->Activate(isac_data_callback);
+    }
 
     if (FAILED(hr))
 #endif
     {
+        ma_context *context = nullptr;
+        if (headless) {
+            ma_backend backend = ma_backend_null;
+            if (ma_context_init(&backend, 1, nullptr, &au_context) != MA_SUCCESS) {
+                log_err("Failed to create a null audio context.");
+                return false;
+            }
+            au_context_used = true;
+            context         = &au_context;
+        }
+
         au_config = ma_device_config_init(ma_device_type_playback);
         au_config.playback.format = SAMPLE_FORMAT;
         au_config.playback.channels = CHANNEL_COUNT;
@@ -255,7 +279,7 @@ bool sound_init() {
         au_config.dataCallback = data_callback;
         au_config.pUserData = nullptr;
 
-        if (ma_device_init(NULL, &au_config, &au_device) != MA_SUCCESS) {
+        if (ma_device_init(context, &au_config, &au_device) != MA_SUCCESS) {
             log_err("Failed to open playback device.");
             return false;
         }
@@ -280,6 +304,10 @@ void sound_update() {
 
 void sound_shutdown() {
     ma_device_uninit (&au_device);
+    if (au_context_used) {
+        ma_context_uninit(&au_context);
+        au_context_used = false;
+    }
 #ifdef _MSC_VER
     delete isac_adapter;
 #endif
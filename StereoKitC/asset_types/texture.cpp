@@ -2,6 +2,7 @@
 #include "../shaders_builtin/shader_builtin.h"
 #include "../systems/d3d.h"
 #include "../systems/platform/platform_utils.h"
+#include "../systems/profiler.h"
 #include "../libraries/stref.h"
 #include "../math.h"
 #include "../spherical_harmonics.h"
@@ -119,6 +120,7 @@ tex_t tex_create_file(const char *file, bool32_t srgb_data) {
 	tex_t result = tex_find(file);
 	if (result != nullptr)
 		return result;
+	profile_zone("tex_create_file");
 
 	void  *file_data;
 	size_t file_size;
@@ -143,6 +145,7 @@ tex_t tex_create_cubemap_file(const char *equirectangular_file, bool32_t srgb_da
 	tex_t result = tex_find(equirectangular_file);
 	if (result != nullptr)
 		return result;
+	profile_zone("tex_create_cubemap_file");
 
 	const vec3 up   [6] = { -vec3_up, -vec3_up, vec3_forward, -vec3_forward, -vec3_up, -vec3_up };
 	const vec3 fwd  [6] = { {1,0,0}, {-1,0,0}, {0,-1,0}, {0,1,0}, {0,0,1}, {0,0,-1} };
@@ -193,6 +196,7 @@ tex_t tex_create_cubemap_files(const char **cube_face_file_xxyyzz, bool32_t srgb
 	tex_t result = tex_find(cube_face_file_xxyyzz[0]);
 	if (result != nullptr)
 		return result;
+	profile_zone("tex_create_cubemap_files");
 
 	// Load all 6 faces
 	uint8_t *data[6] = {};
@@ -430,6 +434,46 @@ void tex_set_active(tex_t texture, int slot) {
 
 ///////////////////////////////////////////
 
+struct tex_mip_job_t {
+	tex_t                   texture;
+	void                  **data;
+	D3D11_SUBRESOURCE_DATA *tex_mem;
+	uint32_t                mip_levels;
+	bool                    mips;
+};
+
+///////////////////////////////////////////
+
+void tex_create_mips(void *data, int32_t start, int32_t end) {
+	tex_mip_job_t          *job     = (tex_mip_job_t *)data;
+	tex_t                   texture = job->texture;
+	D3D11_SUBRESOURCE_DATA *tex_mem = job->tex_mem;
+
+	for (int32_t i = start; i < end; i++) {
+		void *curr_data = job->data[i];
+		
+		tex_mem[i*job->mip_levels].pSysMem     = curr_data;
+		tex_mem[i*job->mip_levels].SysMemPitch = (UINT)(tex_format_size(texture->format) * texture->width);
+
+		if (job->mips) {
+			void    *mip_data     = curr_data;
+			int32_t  mip_width    = texture->width;
+			int32_t  mip_height   = texture->height;
+			for (uint32_t m = 1; m < job->mip_levels; m++) {
+				uint32_t index = i*job->mip_levels + m;
+				if (texture->format == tex_format_rgba128)
+					tex_downsample_128((color128*)mip_data, mip_width, mip_height, (color128**)&tex_mem[index].pSysMem, &mip_width, &mip_height);
+				else
+					tex_downsample    ((color32* )mip_data, mip_width, mip_height, (color32** )&tex_mem[index].pSysMem, &mip_width, &mip_height);
+				mip_data = (void*)tex_mem[index].pSysMem;
+				tex_mem[index].SysMemPitch = (UINT)(tex_format_size(texture->format) * mip_width);
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////
+
 bool tex_create_surface(tex_t texture, void **data, int32_t data_count, spherical_harmonics_t *sh_lighting_info) {
 	if (sh_lighting_info != nullptr) *sh_lighting_info = {};
 
@@ -457,28 +501,12 @@ bool tex_create_surface(tex_t texture, void **data, int32_t data_count, spherica
 	D3D11_SUBRESOURCE_DATA *tex_mem = nullptr;
 	if (data != nullptr && data[0] != nullptr) {
 		tex_mem = (D3D11_SUBRESOURCE_DATA *)malloc(data_count * desc.MipLevels * sizeof(D3D11_SUBRESOURCE_DATA));
-		for (int32_t i = 0; i < data_count; i++) {
-			void *curr_data = data[i];
-		
-			tex_mem[i*desc.MipLevels].pSysMem     = curr_data;
-			tex_mem[i*desc.MipLevels].SysMemPitch = (UINT)(tex_format_size(texture->format) * texture->width);
-
-			if (mips) {
-				void    *mip_data     = curr_data;
-				int32_t  mip_width    = texture->width;
-				int32_t  mip_height   = texture->height;
-				for (uint32_t m = 1; m < desc.MipLevels; m++) {
-					uint32_t index = i*desc.MipLevels + m;
-					if (texture->format == tex_format_rgba128)
-						tex_downsample_128((color128*)mip_data, mip_width, mip_height, (color128**)&tex_mem[index].pSysMem, &mip_width, &mip_height);
-					else
-						tex_downsample    ((color32* )mip_data, mip_width, mip_height, (color32** )&tex_mem[index].pSysMem, &mip_width, &mip_height);
-					mip_data = (void*)tex_mem[index].pSysMem;
-					tex_mem[index].SysMemPitch = (UINT)(tex_format_size(texture->format) * mip_width);
-					
-				}
-			}
-		}
+
+		// Cubemap faces each get their mips built on the job system
+		tex_mip_job_t job     = { texture, data, tex_mem, desc.MipLevels, mips };
+		job_counter_t counter = {};
+		job_parallel_for(0, data_count, 1, tex_create_mips, &job, &counter);
+		job_wait(&counter);
 		if (sh_lighting_info != nullptr) {
 			int32_t lighting_mip = maxi(0, (int32_t)desc.MipLevels-6);
 			void *mip_level[6] = { 
@@ -10,9 +10,9 @@ namespace sk {
 
 ///////////////////////////////////////////
 
-array_t<hierarchy_item_t> hierarchy_stack       = {};
-bool32_t                  hierarchy_enabled     = false;
-bool32_t                  hierarchy_userenabled = true;
+thread_local hierarchy_stack_t hierarchy_stack;
+thread_local bool32_t          hierarchy_enabled     = false;
+thread_local bool32_t          hierarchy_userenabled = true;
 
 ///////////////////////////////////////////
 
@@ -13,8 +13,17 @@ struct hierarchy_item_t {
 
 ///////////////////////////////////////////
 
-extern array_t<hierarchy_item_t> hierarchy_stack;
-extern bool32_t                  hierarchy_enabled;
-extern bool32_t                  hierarchy_userenabled;
+// Frees its memory when its thread exits
+struct hierarchy_stack_t : array_t<hierarchy_item_t> {
+	~hierarchy_stack_t() { free(); }
+};
+
+///////////////////////////////////////////
+
+// Each thread gets its own stack, so worker threads can walk their own
+// part of the scene and submit to the renderer independently.
+extern thread_local hierarchy_stack_t hierarchy_stack;
+extern thread_local bool32_t          hierarchy_enabled;
+extern thread_local bool32_t          hierarchy_userenabled;
 
 }
\ No newline at end of file
@@ -114,4 +114,100 @@ vec3 ray_point_closest(ray_t ray, vec3 pt) {
 	return ray.pos + ray.dir * t;
 }
 
+///////////////////////////////////////////
+
+// Batches of primitive tests are cheap per ray, so only really big ones
+// are worth spreading across threads.
+const int32_t ray_batch_job_size = 1024;
+
+///////////////////////////////////////////
+
+void ray_intersect_x4(const plane_t &plane, const ray_t *rays, vec3 *out_pts, bool32_t *out_hits) {
+	ray4_t   r = ray4_load(rays);
+	XMVECTOR n_x = XMVectorReplicate(plane.normal.x);
+	XMVECTOR n_y = XMVectorReplicate(plane.normal.y);
+	XMVECTOR n_z = XMVectorReplicate(plane.normal.z);
+
+	XMVECTOR pos_n = XMVectorMultiplyAdd(r.pos_z, n_z, XMVectorMultiplyAdd(r.pos_y, n_y, XMVectorMultiplyAdd(r.pos_x, n_x, XMVectorReplicate(plane.d))));
+	XMVECTOR dir_n = XMVectorMultiplyAdd(r.dir_z, n_z, XMVectorMultiplyAdd(r.dir_y, n_y, XMVectorMultiply(r.dir_x, n_x)));
+	XMVECTOR t     = XMVectorNegate(XMVectorDivide(pos_n, dir_n));
+
+	// The single ray version hands back a point even when it misses
+	ray4_store_pts (r, t, XMVectorTrueInt(), out_pts);
+	ray4_store_hits(XMVectorGreaterOrEqual(t, XMVectorZero()), out_hits);
+}
+
+///////////////////////////////////////////
+
+void ray_intersect_x4(const sphere_t &sphere, const ray_t *rays, vec3 *out_pts, bool32_t *out_hits) {
+	ray4_t   r    = ray4_load(rays);
+	XMVECTOR oc_x = XMVectorSubtract(r.pos_x, XMVectorReplicate(sphere.center.x));
+	XMVECTOR oc_y = XMVectorSubtract(r.pos_y, XMVectorReplicate(sphere.center.y));
+	XMVECTOR oc_z = XMVectorSubtract(r.pos_z, XMVectorReplicate(sphere.center.z));
+
+	XMVECTOR b = XMVectorMultiplyAdd(oc_z, r.dir_z, XMVectorMultiplyAdd(oc_y, r.dir_y, XMVectorMultiply(oc_x, r.dir_x)));
+	XMVECTOR c = XMVectorMultiplyAdd(oc_z, oc_z,    XMVectorMultiplyAdd(oc_y, oc_y,    XMVectorMultiply(oc_x, oc_x)));
+	c = XMVectorSubtract(c, XMVectorReplicate(sphere.radius * sphere.radius));
+	XMVECTOR h   = XMVectorSubtract(XMVectorMultiply(b, b), c);
+	XMVECTOR hit = XMVectorGreaterOrEqual(h, XMVectorZero());
+	XMVECTOR t   = XMVectorSubtract(XMVectorNegate(b), XMVectorSqrt(XMVectorMax(h, XMVectorZero())));
+
+	ray4_store_pts (r, t, hit, out_pts);
+	ray4_store_hits(hit, out_hits);
+}
+
+///////////////////////////////////////////
+
+void ray_intersect_x4(const bounds_t &bounds, const ray_t *rays, vec3 *out_pts, bool32_t *out_hits) {
+	ray4_t   r   = ray4_load(rays);
+	XMVECTOR m_x = XMVectorReciprocal(r.dir_x);
+	XMVECTOR m_y = XMVectorReciprocal(r.dir_y);
+	XMVECTOR m_z = XMVectorReciprocal(r.dir_z);
+	XMVECTOR n_x = XMVectorMultiply(m_x, XMVectorSubtract(r.pos_x, XMVectorReplicate(bounds.center.x)));
+	XMVECTOR n_y = XMVectorMultiply(m_y, XMVectorSubtract(r.pos_y, XMVectorReplicate(bounds.center.y)));
+	XMVECTOR n_z = XMVectorMultiply(m_z, XMVectorSubtract(r.pos_z, XMVectorReplicate(bounds.center.z)));
+	XMVECTOR k_x = XMVectorMultiply(XMVectorAbs(m_x), XMVectorReplicate(bounds.dimensions.x / 2));
+	XMVECTOR k_y = XMVectorMultiply(XMVectorAbs(m_y), XMVectorReplicate(bounds.dimensions.y / 2));
+	XMVECTOR k_z = XMVectorMultiply(XMVectorAbs(m_z), XMVectorReplicate(bounds.dimensions.z / 2));
+
+	XMVECTOR t_near = XMVectorMax(XMVectorMax(
+		XMVectorNegate(XMVectorAdd(n_x, k_x)),
+		XMVectorNegate(XMVectorAdd(n_y, k_y))),
+		XMVectorNegate(XMVectorAdd(n_z, k_z)));
+	XMVECTOR t_far = XMVectorMin(XMVectorMin(
+		XMVectorSubtract(k_x, n_x),
+		XMVectorSubtract(k_y, n_y)),
+		XMVectorSubtract(k_z, n_z));
+	XMVECTOR hit = XMVectorAndInt(
+		XMVectorLessOrEqual   (t_near, t_far),
+		XMVectorGreaterOrEqual(t_far,  XMVectorZero()));
+
+	ray4_store_pts (r, t_near, hit, out_pts);
+	ray4_store_hits(hit, out_hits);
+}
+
+///////////////////////////////////////////
+
+bool32_t ray_intersect_x1(const plane_t  &plane,  const ray_t &ray, vec3 *out_pt) { return plane_ray_intersect (plane,  ray, out_pt); }
+bool32_t ray_intersect_x1(const sphere_t &sphere, const ray_t &ray, vec3 *out_pt) { return sphere_ray_intersect(sphere, ray, out_pt); }
+bool32_t ray_intersect_x1(const bounds_t &bounds, const ray_t &ray, vec3 *out_pt) { return bounds_ray_intersect(bounds, ray, out_pt); }
+
+///////////////////////////////////////////
+
+int32_t plane_ray_intersect_batch(plane_t plane, const ray_t *rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits) {
+	return ray_batch_run(plane, rays, ray_count, out_pts, out_hits, ray_batch_job_size);
+}
+
+///////////////////////////////////////////
+
+int32_t sphere_ray_intersect_batch(sphere_t sphere, const ray_t *rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits) {
+	return ray_batch_run(sphere, rays, ray_count, out_pts, out_hits, ray_batch_job_size);
+}
+
+///////////////////////////////////////////
+
+int32_t bounds_ray_intersect_batch(bounds_t bounds, const ray_t *rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits) {
+	return ray_batch_run(bounds, rays, ray_count, out_pts, out_hits, ray_batch_job_size);
+}
+
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <malloc.h>
+#include "../systems/memory_track.h"
 
 template <typename T>
 struct array_t {
@@ -37,11 +38,11 @@ void array_t<T>::resize(int32_t to_capacity) {
 		count = to_capacity;
 
 	void  *old_memory = data;
-	void  *new_memory = malloc(sizeof(T) * to_capacity); 
+	void  *new_memory = sk::sk_malloc(sizeof(T) * to_capacity); 
 	memcpy(new_memory, old_memory, sizeof(T) * count);
 
 	data = (T*)new_memory;
-	::free(old_memory);
+	sk::sk_free(old_memory);
 
 	capacity = to_capacity;
 }
@@ -50,7 +51,7 @@ void array_t<T>::resize(int32_t to_capacity) {
 
 template <typename T>
 void array_t<T>::free() {
-	::free(data); 
+	sk::sk_free(data); 
 	*this = {}; 
 }
 
@@ -59,7 +60,7 @@ void array_t<T>::free() {
 template <typename T>
 array_t<T> array_t<T>::copy() const { 
 	array_t<T> result = { 
-		malloc(sizeof(T) * capacity), 
+		(T*)sk::sk_malloc(sizeof(T) * capacity), 
 		count, 
 		capacity 
 	}; 
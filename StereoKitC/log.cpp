@@ -3,6 +3,8 @@
 #include "libraries/stref.h"
 #include "libraries/array.h"
 #include "systems/platform/platform_utils.h"
+#include "systems/frame_alloc.h"
+#include "systems/memory_track.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -111,7 +113,7 @@ char *log_replace_colors(const char *text, const char **color_keys, const char *
 		return nullptr;
 
 	// New string with new color values
-	char *result = (char*)malloc((len - remove) + (add * code_size));
+	char *result = (char*)frame_scratch_alloc((len - remove) + (add * code_size));
 	char *at = result;
 	ch   = text;
 	curr = 0;
@@ -168,8 +170,12 @@ void log_write(log_ level, const char *text) {
 		break;
 	}
 
+	// Formatting memory all comes from this thread's scratch arena
+	memory_scope(memory_tag_log);
+	frame_mark_t mark = frame_scratch_mark();
+
 	size_t len       = strlen(tag) + strlen(text) + 10;
-	char  *full_text = (char*)malloc(len * sizeof(char));
+	char  *full_text = (char*)frame_scratch_alloc(len * sizeof(char));
 	sprintf_s(full_text, len, "[SK %s] %s\n", tag, text);
 
 	char *colored_text = log_replace_colors(full_text, log_colorkeys[log_colors], log_colorcodes[log_colors], log_code_count[log_colors], log_code_size[log_colors]);
@@ -177,7 +183,6 @@ void log_write(log_ level, const char *text) {
 	
 	// OutputDebugStringA shows up in the VS output, and doesn't display colors at all
 	if (log_colors != log_colors_none) {
-		free(colored_text);
 		colored_text = log_replace_colors(full_text, log_colorkeys[log_colors_none], log_colorcodes[log_colors_none], log_code_count[log_colors_none], log_code_size[log_colors_none]);
 	}
 	// Send the plain-text version out to the listeners as well
@@ -185,20 +190,20 @@ void log_write(log_ level, const char *text) {
 		log_listeners[i](level, colored_text);
 	}
 	platform_debug_output(colored_text);
-	free(colored_text);
-	
-	free(full_text);
+
+	frame_scratch_release(mark);
 }
 
 ///////////////////////////////////////////
 
 void _log_writef(log_ level, const char* text, va_list args) {
-	size_t length = vsnprintf(nullptr, 0, text, args);
-	char* buffer = (char*)malloc(length + 2);
+	frame_mark_t mark   = frame_scratch_mark();
+	size_t       length = vsnprintf(nullptr, 0, text, args);
+	char*        buffer = (char*)frame_scratch_alloc(length + 2);
 	vsnprintf(buffer, length + 2, text, args);
 
 	log_write(level, buffer);
-	free(buffer);
+	frame_scratch_release(mark);
 }
 
 ///////////////////////////////////////////
@@ -271,12 +276,13 @@ void log_fail_reason(int32_t confidence, const char *fail_reason) {
 void log_fail_reasonf(int32_t confidence, const char *fail_reason, ...) {
 	va_list args;
 	va_start(args, fail_reason);
-	size_t length = vsnprintf(nullptr, 0, fail_reason, args);
-	char* buffer = (char*)malloc(length + 2);
+	frame_mark_t mark   = frame_scratch_mark();
+	size_t       length = vsnprintf(nullptr, 0, fail_reason, args);
+	char*        buffer = (char*)frame_scratch_alloc(length + 2);
 	vsnprintf(buffer, length + 2, fail_reason, args);
 
 	log_fail_reason(confidence, buffer);
-	free(buffer);
+	frame_scratch_release(mark);
 	va_end(args);
 }
 
@@ -301,6 +307,7 @@ void log_clear_any_fail_reason() {
 ///////////////////////////////////////////
 
 void log_subscribe(void (*on_log)(log_, const char*)) {
+	memory_scope(memory_tag_log);
 	log_listeners.add(on_log);
 }
 
@@ -67,6 +67,97 @@ inline float math_ease_hop      (float a, float peak, float t) { return a+(peak-
 vec3 bounds_corner (const bounds_t &bounds, int32_t index8);
 vec3 math_cubemap_corner(int i);
 
+///////////////////////////////////////////
+
+// Four rays in SoA form, so one SIMD op works on all four at once
+struct ray4_t {
+	DirectX::XMVECTOR pos_x, pos_y, pos_z;
+	DirectX::XMVECTOR dir_x, dir_y, dir_z;
+};
+
+inline ray4_t ray4_load(const ray_t *rays) {
+	DirectX::XMMATRIX pos, dir;
+	for (int32_t i = 0; i < 4; i++) {
+		pos.r[i] = math_vec3_to_fast(rays[i].pos);
+		dir.r[i] = math_vec3_to_fast(rays[i].dir);
+	}
+	pos = DirectX::XMMatrixTranspose(pos);
+	dir = DirectX::XMMatrixTranspose(dir);
+	return { pos.r[0], pos.r[1], pos.r[2], dir.r[0], dir.r[1], dir.r[2] };
+}
+
+///////////////////////////////////////////
+
+// Stores pos + dir*t for each ray. Rays outside pt_mask get a zero point,
+// same as the single ray functions give on a miss.
+inline void ray4_store_pts(const ray4_t &rays, const DirectX::XMVECTOR &t, const DirectX::XMVECTOR &pt_mask, vec3 *out_pts) {
+	DirectX::XMVECTOR zero = DirectX::XMVectorZero();
+	DirectX::XMMATRIX pts;
+	pts.r[0] = DirectX::XMVectorSelect(zero, DirectX::XMVectorMultiplyAdd(rays.dir_x, t, rays.pos_x), pt_mask);
+	pts.r[1] = DirectX::XMVectorSelect(zero, DirectX::XMVectorMultiplyAdd(rays.dir_y, t, rays.pos_y), pt_mask);
+	pts.r[2] = DirectX::XMVectorSelect(zero, DirectX::XMVectorMultiplyAdd(rays.dir_z, t, rays.pos_z), pt_mask);
+	pts.r[3] = zero;
+	pts = DirectX::XMMatrixTranspose(pts);
+	for (int32_t i = 0; i < 4; i++)
+		out_pts[i] = math_fast_to_vec3(pts.r[i]);
+}
+
+///////////////////////////////////////////
+
+inline void ray4_store_hits(const DirectX::XMVECTOR &hit_mask, bool32_t *out_hits) {
+	uint32_t hits[4];
+	DirectX::XMStoreInt4(hits, hit_mask);
+	for (int32_t i = 0; i < 4; i++)
+		out_hits[i] = hits[i] != 0;
+}
+
+///////////////////////////////////////////
+
+void     ray_intersect_x4(const plane_t  &plane,  const ray_t *rays, vec3 *out_pts, bool32_t *out_hits);
+void     ray_intersect_x4(const sphere_t &sphere, const ray_t *rays, vec3 *out_pts, bool32_t *out_hits);
+void     ray_intersect_x4(const bounds_t &bounds, const ray_t *rays, vec3 *out_pts, bool32_t *out_hits);
+bool32_t ray_intersect_x1(const plane_t  &plane,  const ray_t &ray,  vec3 *out_pt);
+bool32_t ray_intersect_x1(const sphere_t &sphere, const ray_t &ray,  vec3 *out_pt);
+bool32_t ray_intersect_x1(const bounds_t &bounds, const ray_t &ray,  vec3 *out_pt);
+
+///////////////////////////////////////////
+
+// Batched ray queries. Each shape type provides ray_intersect_x4 for four
+// rays at a time, and ray_intersect_x1 for the leftovers. Big batches get
+// split into jobs of job_size rays.
+template<typename T>
+struct ray_batch_t {
+	const T     *shape;
+	const ray_t *rays;
+	vec3        *out_pts;
+	bool32_t    *out_hits;
+};
+
+template<typename T>
+void ray_batch_range(void *data, int32_t start, int32_t end) {
+	const ray_batch_t<T> &batch = *(ray_batch_t<T>*)data;
+	int32_t i = start;
+	for (; i + 4 <= end; i += 4) ray_intersect_x4(*batch.shape, &batch.rays[i], &batch.out_pts[i], &batch.out_hits[i]);
+	for (; i < end; i++)         batch.out_hits[i] = ray_intersect_x1(*batch.shape, batch.rays[i], &batch.out_pts[i]);
+}
+
+template<typename T>
+int32_t ray_batch_run(const T &shape, const ray_t *rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits, int32_t job_size) {
+	ray_batch_t<T> batch = { &shape, rays, out_pts, out_hits };
+	if (ray_count >= job_size * 2 && job_worker_count() > 0) {
+		job_counter_t counter = {};
+		job_parallel_for(0, ray_count, job_size, ray_batch_range<T>, &batch, &counter);
+		job_wait(&counter);
+	} else {
+		ray_batch_range<T>(&batch, 0, ray_count);
+	}
+
+	int32_t hits = 0;
+	for (int32_t i = 0; i < ray_count; i++)
+		if (out_hits[i]) hits += 1;
+	return hits;
+}
+
 
 
 } // namespace sk
\ No newline at end of file
@@ -41,16 +41,25 @@ void sh_add(spherical_harmonics_t &to, vec3 light_dir, color128 light_color) {
 
 ///////////////////////////////////////////
 
-spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int32_t face_size) {
-	spherical_harmonics_t result = {};
-	size_t   col_size            = tex_format_size(format);
-	vec3   (*convert)(uint8_t *) = format == tex_format_rgba128 ?
-		to_color_128 :
-		to_color_32;
+struct sh_calculate_job_t {
+	void                **env_map_data;
+	vec3                (*convert)(uint8_t *);
+	size_t                col_size;
+	int32_t               face_size;
+	spherical_harmonics_t faces[6];
+};
+
+///////////////////////////////////////////
+
+void sh_calculate_faces(void *data, int32_t start, int32_t end) {
+	sh_calculate_job_t *job       = (sh_calculate_job_t *)data;
+	int32_t             face_size = job->face_size;
+	size_t              col_size  = job->col_size;
 
 	float half_px = 0.5f / face_size;
-	for (int32_t i = 0; i < 6; i++) {
-		uint8_t *data = (uint8_t*)env_map_data[i];
+	for (int32_t i = start; i < end; i++) {
+		spherical_harmonics_t &result = job->faces[i];
+		uint8_t *data = (uint8_t*)job->env_map_data[i];
 		vec3 p1 = math_cubemap_corner(i * 4);
 		vec3 p2 = math_cubemap_corner(i * 4+1);
 		vec3 p3 = math_cubemap_corner(i * 4+2);
@@ -76,7 +85,7 @@ spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int3
 				vec3 pt = vec3_lerp(pl, pr, px);
 				pt = vec3_normalize(pt);
 
-				vec3 color = convert(&data[(x + y * face_size) * col_size]);
+				vec3 color = job->convert(&data[(x + y * face_size) * col_size]);
 
 				// From here:
 				// https://graphics.stanford.edu/papers/envmap/envmap.pdf
@@ -92,10 +101,32 @@ spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int3
 			}
 		}
 	}
+}
+
+///////////////////////////////////////////
+
+spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int32_t face_size) {
+	// Each face is summed up separately on the job system, and combined
+	// at the end.
+	sh_calculate_job_t job = {};
+	job.env_map_data = env_map_data;
+	job.col_size     = tex_format_size(format);
+	job.face_size    = face_size;
+	job.convert      = format == tex_format_rgba128 ?
+		to_color_128 :
+		to_color_32;
 
+	job_counter_t counter = {};
+	job_parallel_for(0, 6, 1, sh_calculate_faces, &job, &counter);
+	job_wait(&counter);
+
+	spherical_harmonics_t result = {};
 	float count = face_size * face_size * 6.f;
-	for (size_t i = 0; i < 9; i++)
+	for (size_t i = 0; i < 9; i++) {
+		for (int32_t f = 0; f < 6; f++)
+			result.coefficients[i] += job.faces[f].coefficients[i];
 		result.coefficients[i] /= count;
+	}
 
 	return result;
 }
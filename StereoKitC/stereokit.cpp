@@ -11,6 +11,9 @@
 #include "systems/sprite_drawer.h"
 #include "systems/line_drawer.h"
 #include "systems/defaults.h"
+#include "systems/job.h"
+#include "systems/profiler.h"
+#include "systems/memory_track.h"
 #include "systems/platform/platform.h"
 #include "asset_types/sound.h"
 
@@ -46,6 +49,7 @@ float   sk_timev_elapsedf = 0;
 double  sk_timev_elapsed_us  = 0;
 float   sk_timev_elapsedf_us = 0;
 int64_t sk_timev_raw      = 0;
+double  sk_headless_step  = 1 / 90.0;
 
 ///////////////////////////////////////////
 
@@ -103,8 +107,11 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 	sk_update_timer();
 
 	systems_add("Platform", nullptr, 0, nullptr, 0, platform_init, nullptr, platform_shutdown);
+	systems_add("Jobs",     nullptr, 0, nullptr, 0, job_init,      nullptr, job_shutdown);
+	systems_add("Profiler", nullptr, 0, nullptr, 0, profiler_init, nullptr, profiler_shutdown);
+	systems_add("Memory",   nullptr, 0, nullptr, 0, nullptr,       memory_update, memory_shutdown);
 
-	const char *default_deps[] = {"Platform"};
+	const char *default_deps[] = {"Platform", "Jobs"};
 	systems_add("Defaults", default_deps, _countof(default_deps), nullptr, 0, defaults_init, nullptr, defaults_shutdown);
 
 	const char *ui_deps       [] = {"Defaults"};
@@ -129,7 +136,7 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 		render_initialize, render_update, render_shutdown);
 
 	const char *sound_deps[] = {"Platform"};
-	const char *sound_update_deps[] = {"Platform"};
+	const char *sound_update_deps[] = {"Platform", "Input"};
 	systems_add("Sound",  
 		sound_deps,        _countof(sound_deps), 
 		sound_update_deps, _countof(sound_update_deps),
@@ -172,6 +179,19 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 	const char *platform_present_deps[] = {"FrameRender"};
 	systems_add("FramePresent", nullptr, 0, platform_present_deps, _countof(platform_present_deps), nullptr, platform_present,   nullptr);
 
+	// These don't touch the graphics context, so they can update on worker
+	// threads alongside everything else.
+	systems_set_threadsafe("Physics");
+	systems_set_threadsafe("Sound");
+
+	systems_set_memory_tag("Renderer", memory_tag_render);
+	systems_set_memory_tag("Sprites",  memory_tag_render);
+	systems_set_memory_tag("Lines",    memory_tag_render);
+	systems_set_memory_tag("Text",     memory_tag_text);
+	systems_set_memory_tag("UI",       memory_tag_ui);
+	systems_set_memory_tag("Sound",    memory_tag_audio);
+	systems_set_memory_tag("Physics",  memory_tag_physics);
+
 	sk_initialized = systems_initialize();
 	if (!sk_initialized) log_show_any_fail_reason();
 	else                 log_clear_any_fail_reason();
@@ -208,6 +228,35 @@ bool32_t sk_step(void (*app_update)(void)) {
 
 ///////////////////////////////////////////
 
+bool32_t sk_headless_run(int32_t frame_count, double time_step, void (*app_update)(void), void (*input_update)(int32_t frame), const char *report_file) {
+	if (!sk_initialized || sk_runtime != runtime_headless) {
+		log_err("sk_headless_run: StereoKit must be initialized with runtime_headless first!");
+		return false;
+	}
+	if (time_step <= 0) {
+		log_err("sk_headless_run: time_step must be greater than zero!");
+		return false;
+	}
+
+	// Every run starts from the same time, and steps it by a fixed amount,
+	// so frames see identical timings no matter how fast the machine is.
+	sk_headless_step = time_step;
+	time_set_time(0, time_step);
+
+	// Frames from before the run would skew its stats and report
+	systems_reset_history();
+
+	for (int32_t i = 0; i < frame_count && sk_run; i++) {
+		if (input_update != nullptr)
+			input_update(i);
+		sk_step(app_update);
+	}
+
+	return report_file == nullptr || systems_write_report(report_file);
+}
+
+///////////////////////////////////////////
+
 void sk_update_timer() {
 	time_point<high_resolution_clock> now = high_resolution_clock::now();
 	sk_timev_raw = duration_cast<nanoseconds>(now.time_since_epoch()).count();
@@ -216,6 +265,8 @@ void sk_update_timer() {
 	if (sk_time_start == 0)
 		sk_time_start = time_curr;
 	double new_time = time_curr - sk_time_start;
+	if (sk_runtime == runtime_headless)
+		new_time = sk_timev_us + sk_headless_step;
 	sk_timev_elapsed_us  =  new_time - sk_timev_us;
 	sk_timev_elapsed     = (new_time - sk_timev_us) * sk_timev_scale;
 	sk_timev_us          = new_time;
@@ -52,7 +52,8 @@ typedef int32_t bool32_t;
 
 typedef enum runtime_ {
 	runtime_flatscreen   = 0,
-	runtime_mixedreality = 1
+	runtime_mixedreality = 1,
+	runtime_headless     = 2
 } runtime_;
 
 typedef struct settings_t {
@@ -62,6 +63,7 @@ typedef struct settings_t {
 	int32_t flatscreen_height;
 	char assets_folder[128];
 	bool32_t disable_flatscreen_mr_sim;
+	bool32_t disable_mesh_optimize;
 } settings_t;
 
 typedef enum display_ {
@@ -81,12 +83,60 @@ SK_API bool32_t      sk_init          (const char *app_name, runtime_ preferred_
 SK_API void          sk_shutdown      ();
 SK_API void          sk_quit          ();
 SK_API bool32_t      sk_step          (void (*app_update)(void));
+SK_API bool32_t      sk_headless_run  (int32_t frame_count, double time_step, void (*app_update)(void), void (*input_update)(int32_t frame), const char *report_file);
 SK_API runtime_      sk_active_runtime();
 SK_API void          sk_set_settings  (const sk_ref(settings_t) settings);
 SK_API system_info_t sk_system_info   ();
 SK_API const char   *sk_version_name  ();
 SK_API uint64_t      sk_version_id    ();
 
+typedef struct frame_stats_t {
+	int32_t frame_count;
+	int32_t over_budget;
+	float   ms_p50;
+	float   ms_p95;
+	float   ms_p99;
+	float   ms_max;
+	int64_t frame_mem_peak;
+	int64_t scratch_mem_peak;
+} frame_stats_t;
+
+SK_API frame_stats_t sk_frame_stats       (int32_t frame_count sk_default(0));
+SK_API frame_stats_t sk_system_frame_stats(const char *system_name, int32_t frame_count sk_default(0));
+SK_API void          sk_set_frame_budget  (float budget_ms);
+SK_API int64_t       sk_frames_over_budget();
+
+typedef enum memory_tag_ {
+	memory_tag_general = 0,
+	memory_tag_mesh,
+	memory_tag_tex,
+	memory_tag_shader,
+	memory_tag_material,
+	memory_tag_model,
+	memory_tag_font,
+	memory_tag_sprite,
+	memory_tag_sound,
+	memory_tag_render,
+	memory_tag_text,
+	memory_tag_ui,
+	memory_tag_audio,
+	memory_tag_physics,
+	memory_tag_log,
+	memory_tag_max,
+} memory_tag_;
+
+typedef struct memory_stats_t {
+	int64_t live_bytes;
+	int64_t peak_bytes;
+	int64_t live_count;
+	int64_t total_count;
+} memory_stats_t;
+
+SK_API memory_stats_t sk_memory_stats            (memory_tag_ tag);
+SK_API const char    *sk_memory_tag_name         (memory_tag_ tag);
+SK_API void           sk_memory_dump             ();
+SK_API void           sk_set_memory_dump_interval(float seconds);
+
 ///////////////////////////////////////////
 
 SK_API float    time_getf_unscaled();
@@ -248,6 +298,12 @@ SK_API bool32_t bounds_point_contains(bounds_t bounds, vec3 pt);
 SK_API bool32_t bounds_line_contains (bounds_t bounds, vec3 pt1, vec3 pt2);
 SK_API vec3     ray_point_closest    (ray_t ray, vec3 pt);
 
+// Batch versions test many rays against one shape, filling out_pts and
+// out_hits for each ray, and return how many rays hit.
+SK_API int32_t  plane_ray_intersect_batch (plane_t  plane,  const ray_t *rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits);
+SK_API int32_t  sphere_ray_intersect_batch(sphere_t sphere, const ray_t *rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits);
+SK_API int32_t  bounds_ray_intersect_batch(bounds_t bounds, const ray_t *rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits);
+
 ///////////////////////////////////////////
 
 typedef struct color32 {
@@ -333,6 +389,8 @@ SK_API void     mesh_set_draw_inds(mesh_t mesh, int32_t index_count);
 SK_API void     mesh_set_bounds   (mesh_t mesh, const sk_ref(bounds_t) bounds);
 SK_API bounds_t mesh_get_bounds   (mesh_t mesh);
 SK_API bool32_t mesh_ray_intersect(mesh_t mesh, ray_t model_space_ray, vec3 *out_pt);
+SK_API int32_t  mesh_ray_intersect_batch(mesh_t mesh, const ray_t *model_space_rays, int32_t ray_count, vec3 *out_pts, bool32_t *out_hits);
+SK_API void     mesh_optimize     (mesh_t mesh, bool32_t overdraw sk_default(false));
 
 SK_API mesh_t mesh_gen_plane       (vec2 dimensions, vec3 plane_normal, vec3 plane_top_direction, int32_t subdivisions sk_default(0));
 SK_API mesh_t mesh_gen_cube        (vec3 dimensions, int32_t subdivisions sk_default(0));
@@ -536,6 +594,16 @@ SK_API void    solid_get_pose        (const solid_t solid, sk_ref(pose_t) out_po
 
 SK_DeclarePrivateType(model_t);
 
+// triangle indexes into the subset mesh's inds, in groups of three, and
+// barycentric holds the weights of that triangle's three verts.
+typedef struct model_hit_t {
+	vec3    pt;
+	float   distance;
+	int32_t subset;
+	int32_t triangle;
+	vec3    barycentric;
+} model_hit_t;
+
 SK_API model_t    model_find         (const char *id);
 SK_API model_t    model_create       ();
 SK_API model_t    model_create_mesh  (mesh_t mesh, material_t material);
@@ -552,9 +620,12 @@ SK_API void       model_set_transform(model_t model, int32_t subset, const sk_re
 SK_API void       model_remove_subset(model_t model, int32_t subset);
 SK_API int32_t    model_add_subset   (model_t model, mesh_t mesh, material_t material, const sk_ref(matrix) transform);
 SK_API int32_t    model_subset_count (model_t model);
+SK_API int32_t    model_add_lod      (model_t model, int32_t subset, mesh_t mesh, float max_screen_size);
+SK_API void       model_optimize     (model_t model);
 SK_API void       model_recalculate_bounds(model_t model);
 SK_API void       model_set_bounds   (model_t model, const sk_ref(bounds_t) bounds);
 SK_API bounds_t   model_get_bounds   (model_t model);
+SK_API bool32_t   model_ray_intersect(model_t model, ray_t model_space_ray, model_hit_t *out_hit);
 
 ///////////////////////////////////////////
 
@@ -602,10 +673,58 @@ SK_API void     render_enable_skytex (bool32_t show_sky);
 SK_API bool32_t render_enabled_skytex();
 SK_API void     render_add_mesh      (mesh_t mesh, material_t material, const sk_ref(matrix) transform, color128 color sk_default((color128{1,1,1,1})));
 SK_API void     render_add_model     (model_t model, const sk_ref(matrix) transform, color128 color sk_default((color128{1,1,1,1})));
+SK_API void     render_add_occluder  (mesh_t mesh, const sk_ref(matrix) transform);
 SK_API void     render_blit          (tex_t to_rendertarget, material_t material);
 SK_API void     render_screenshot    (vec3 from_viewpt, vec3 at, int width, int height, const char *file);
 SK_API void     render_get_device    (void **device, void **context);
 
+typedef struct render_stats_t {
+	int32_t swaps_mesh;
+	int32_t swaps_shader;
+	int32_t swaps_texture;
+	int32_t swaps_material;
+	int32_t draw_calls;
+	int32_t draw_instances;
+	int32_t culled_frustum;
+	int32_t culled_occlusion;
+	int32_t lod_counts[8];
+	float   ms_cull;
+	float   ms_occlusion;
+	float   ms_sort;
+	float   ms_instances;
+	float   ms_submit;
+} render_stats_t;
+
+SK_API render_stats_t render_get_stats();
+SK_API void           render_set_pipelined(bool32_t pipelined);
+SK_API bool32_t       render_get_pipelined();
+
+SK_DeclarePrivateType(render_instance_t);
+
+SK_API render_instance_t render_instance_create       (model_t model, const sk_ref(matrix) transform, color128 color sk_default((color128{1,1,1,1})));
+SK_API render_instance_t render_instance_create_mesh  (mesh_t mesh, material_t material, const sk_ref(matrix) transform, color128 color sk_default((color128{1,1,1,1})));
+SK_API void              render_instance_set_transform(render_instance_t instance, const sk_ref(matrix) transform);
+SK_API void              render_instance_destroy      (render_instance_t instance);
+
+SK_DeclarePrivateType(render_list_t);
+
+typedef enum render_sort_ {
+	render_sort_material = 0,
+	render_sort_depth,
+} render_sort_;
+
+SK_API void           render_set_sort      (render_sort_ sort);
+SK_API render_sort_   render_get_sort      ();
+
+SK_API render_list_t  render_list_create   ();
+SK_API void           render_list_free     (render_list_t list);
+SK_API void           render_list_push     (render_list_t list);
+SK_API void           render_list_pop      ();
+SK_API void           render_list_clear    (render_list_t list);
+SK_API void           render_list_set_sort (render_list_t list, render_sort_ sort);
+SK_API render_stats_t render_list_get_stats(render_list_t list);
+SK_API void           render_list_execute  (render_list_t list, tex_t to_rendertarget, const matrix *views, const matrix *projections, int32_t view_count);
+
 ///////////////////////////////////////////
 
 SK_API void     hierarchy_push       (const sk_ref(matrix) transform);
@@ -738,6 +857,24 @@ SK_API pose_t pose_from_spatial(uint8_t spatial_graph_node_id[16]);
 
 ///////////////////////////////////////////
 
+typedef struct job_counter_t {
+	int32_t pending;
+} job_counter_t;
+
+SK_API void    job_submit      (void (*job)(void *data), void *data, job_counter_t *counter sk_default(nullptr));
+SK_API void    job_parallel_for(int32_t start, int32_t end, int32_t batch_size, void (*job)(void *data, int32_t start, int32_t end), void *data, job_counter_t *counter sk_default(nullptr));
+SK_API void    job_wait        (job_counter_t *counter);
+SK_API int32_t job_worker_count();
+
+///////////////////////////////////////////
+
+SK_API void     profiler_capture   (int32_t frame_count, const char *filename);
+SK_API bool32_t profiler_capturing ();
+SK_API void     profiler_zone_begin(const char *name);
+SK_API void     profiler_zone_end  ();
+
+///////////////////////////////////////////
+
 typedef enum log_{
 	log_diagnostic = 0,
 	log_inform,
@@ -5,6 +5,7 @@
 #include "systems/hand/input_hand.h"
 #include "libraries/stref.h"
 #include "libraries/array.h"
+#include "systems/memory_track.h"
 
 #define SL_IMPLEMENTATION
 #include "libraries/sort_list.h"
@@ -383,6 +384,7 @@ uint64_t ui_stack_hash(const char *string) {
 ///////////////////////////////////////////
 
 uint64_t ui_push_id(const char *id) {
+	memory_scope(memory_tag_ui);
 	uint64_t result = ui_stack_hash(id);
 	skui_id_stack.add({ result });
 	return result;
@@ -409,6 +411,7 @@ void ui_push_pose(pose_t &pose, vec3 offset) {
 	matrix trs   = matrix_trs(pose.position + right*offset, pose.orientation);
 	hierarchy_push(trs);
 
+	memory_scope(memory_tag_ui);
 	skui_layers.add(layer_t{
 		nullptr,
 		vec3{skui_settings.padding, -skui_settings.padding}, 
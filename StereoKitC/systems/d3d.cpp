@@ -19,7 +19,7 @@ int                       d3d_screen_height = 480;
 
 ///////////////////////////////////////////
 
-bool d3d_init(LUID *adapter_id) {
+bool d3d_init(LUID *adapter_id, bool software) {
 	UINT creation_flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
 #ifdef _DEBUG
 	creation_flags |= D3D11_CREATE_DEVICE_DEBUG;
@@ -47,8 +47,10 @@ bool d3d_init(LUID *adapter_id) {
 		dxgi_factory->Release();
 	}
 
+	D3D_DRIVER_TYPE driver = final_adapter != nullptr ? D3D_DRIVER_TYPE_UNKNOWN : (software ? D3D_DRIVER_TYPE_WARP : D3D_DRIVER_TYPE_HARDWARE);
+
 	D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0 };
-	HRESULT hr = D3D11CreateDevice(final_adapter, final_adapter == nullptr ? D3D_DRIVER_TYPE_HARDWARE : D3D_DRIVER_TYPE_UNKNOWN, 0, creation_flags, featureLevels, _countof(featureLevels), D3D11_SDK_VERSION, &d3d_device, nullptr, &d3d_context);
+	HRESULT hr = D3D11CreateDevice(final_adapter, driver, 0, creation_flags, featureLevels, _countof(featureLevels), D3D11_SDK_VERSION, &d3d_device, nullptr, &d3d_context);
 	if (FAILED(hr)) {
 		log_fail_reasonf(90, "Failed to initialize Direct3D 11 - 0x%08x", hr);
 		return false;
@@ -18,7 +18,7 @@ extern ID3D11Device           *d3d_device;
 extern ID3D11DeviceContext    *d3d_context;
 extern ID3D11RasterizerState  *d3d_rasterstate;
 
-bool d3d_init    (LUID *adapter_id);
+bool d3d_init    (LUID *adapter_id, bool software = false);
 void d3d_update  ();
 void d3d_shutdown();
 
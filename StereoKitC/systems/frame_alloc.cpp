@@ -0,0 +1,218 @@
+#include "frame_alloc.h"
+#include "memory_track.h"
+#include "../libraries/array.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct arena_block_t {
+	uint8_t *data;
+	size_t   size;
+	size_t   used;
+};
+
+struct arena_t {
+	array_t<arena_block_t> blocks;
+	int32_t                current;
+	size_t                 used;
+	size_t                 peak;
+	void                  *last;
+	// High-water since the arena was last empty, and the last frame that
+	// went over the keep size.
+	size_t                 recent;
+	uint64_t               over_frame;
+};
+
+// Thread-local arenas clean up after themselves when their thread exits
+struct arena_local_t {
+	arena_t arena = {};
+	~arena_local_t();
+};
+
+///////////////////////////////////////////
+
+const size_t   arena_align         = 16;
+const size_t   arena_block_size    = 64 * 1024;
+// Scratch arenas live as long as their thread, so one big job shouldn't
+// pin its memory forever. Once an arena has gone this many frames without
+// needing more than the keep size, it shrinks back down to it.
+const size_t   arena_scratch_keep  = 1024 * 1024;
+const uint64_t arena_shrink_frames = 120;
+
+arena_t                    frame_arena         = {};
+thread_local arena_local_t frame_scratch_local;
+std::atomic<size_t>        frame_scratch_max   = {0};
+std::atomic<uint64_t>      frame_alloc_frames  = {0};
+
+///////////////////////////////////////////
+
+void arena_free(arena_t &arena) {
+	for (int32_t i = 0; i < arena.blocks.count; i++)
+		sk_free(arena.blocks[i].data);
+	arena.blocks.free();
+	arena = {};
+}
+
+///////////////////////////////////////////
+
+arena_local_t::~arena_local_t() {
+	arena_free(arena);
+}
+
+///////////////////////////////////////////
+
+void *arena_alloc(arena_t &arena, size_t size) {
+	size = (size + (arena_align - 1)) & ~(arena_align - 1);
+
+	// Move on to the next block if this one's full, and add a bigger one
+	// once we run out.
+	while (arena.current >= arena.blocks.count || arena.blocks[arena.current].used + size > arena.blocks[arena.current].size) {
+		if (arena.current < arena.blocks.count)
+			arena.current += 1;
+		if (arena.current >= arena.blocks.count) {
+			size_t block_size = arena.blocks.count > 0 ? arena.blocks.last().size * 2 : arena_block_size;
+			while (block_size < size) block_size *= 2;
+			arena.blocks.add({ (uint8_t*)sk_malloc(block_size), block_size, 0 });
+			break;
+		}
+		arena.blocks[arena.current].used = 0;
+	}
+
+	arena_block_t &block  = arena.blocks[arena.current];
+	void          *result = block.data + block.used;
+	block.used += size;
+	arena.used += size;
+	arena.last  = result;
+	if (arena.peak < arena.used)
+		arena.peak = arena.used;
+	if (arena.recent < arena.used)
+		arena.recent = arena.used;
+	return result;
+}
+
+///////////////////////////////////////////
+
+void arena_release(arena_t &arena, frame_mark_t mark, size_t keep) {
+	arena.last = nullptr;
+	arena.used = mark.used;
+	if (mark.used == 0 && arena.blocks.count > 0) {
+		uint64_t frame = frame_alloc_frames.load(std::memory_order_relaxed);
+		if (arena.recent > keep)
+			arena.over_frame = frame;
+		arena.recent = 0;
+
+		size_t total = 0;
+		for (int32_t i = 0; i < arena.blocks.count; i++)
+			total += arena.blocks[i].size;
+		size_t size = total > keep && frame - arena.over_frame > arena_shrink_frames
+			? keep
+			: total;
+
+		// The arena is empty, so this is a good time to merge blocks into
+		// one big enough for everything, and keep it contiguous next time.
+		if (arena.blocks.count > 1 || size != total) {
+			for (int32_t i = 0; i < arena.blocks.count; i++)
+				sk_free(arena.blocks[i].data);
+			arena.blocks.clear();
+			arena.blocks.add({ (uint8_t*)sk_malloc(size), size, 0 });
+			arena.current = 0;
+			return;
+		}
+	}
+
+	arena.current = mark.block;
+	if (arena.current < arena.blocks.count)
+		arena.blocks[arena.current].used = mark.block_used;
+}
+
+///////////////////////////////////////////
+
+void *frame_alloc(size_t size) {
+	return arena_alloc(frame_arena, size);
+}
+
+///////////////////////////////////////////
+
+void *frame_realloc(void *memory, size_t old_size, size_t new_size) {
+	if (memory == nullptr)
+		return frame_alloc(new_size);
+	if (new_size <= old_size)
+		return memory;
+
+	// The most recent allocation can usually just grow in place
+	if (memory == frame_arena.last) {
+		arena_block_t &block = frame_arena.blocks[frame_arena.current];
+		size_t start = (uint8_t*)memory - block.data;
+		size_t size  = (new_size + (arena_align - 1)) & ~(arena_align - 1);
+		if (start + size <= block.size) {
+			frame_arena.used += (start + size) - block.used;
+			block.used        = start + size;
+			if (frame_arena.peak < frame_arena.used)
+				frame_arena.peak = frame_arena.used;
+			return memory;
+		}
+	}
+
+	void *result = frame_alloc(new_size);
+	memcpy(result, memory, old_size);
+	return result;
+}
+
+///////////////////////////////////////////
+
+frame_mark_t frame_scratch_mark() {
+	arena_t &arena = frame_scratch_local.arena;
+	return frame_mark_t{
+		arena.current,
+		arena.current < arena.blocks.count ? arena.blocks[arena.current].used : 0,
+		arena.used };
+}
+
+///////////////////////////////////////////
+
+void *frame_scratch_alloc(size_t size) {
+	arena_t &arena  = frame_scratch_local.arena;
+	void    *result = arena_alloc(arena, size);
+
+	size_t peak = frame_scratch_max.load(std::memory_order_relaxed);
+	while (peak < arena.peak && !frame_scratch_max.compare_exchange_weak(peak, arena.peak, std::memory_order_relaxed)) {}
+	return result;
+}
+
+///////////////////////////////////////////
+
+void frame_scratch_release(frame_mark_t mark) {
+	arena_release(frame_scratch_local.arena, mark, arena_scratch_keep);
+}
+
+///////////////////////////////////////////
+
+size_t frame_alloc_peak() {
+	return frame_arena.peak;
+}
+
+///////////////////////////////////////////
+
+size_t frame_scratch_peak() {
+	return frame_scratch_max.load(std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////
+
+void frame_alloc_end() {
+	arena_release(frame_arena, {}, SIZE_MAX);
+	frame_alloc_frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////
+
+void frame_alloc_shutdown() {
+	arena_free(frame_arena);
+}
+
+} // namespace sk
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sk {
+
+// Linear allocators for data that doesn't outlive a frame. Nothing here
+// gets freed individually, the memory just gets handed out again once the
+// owner is done with it.
+
+// The frame arena is for the main thread. Allocations stay valid until the
+// current frame wraps up, so anything allocated between sk_step calls is
+// still around for the next frame's systems.
+void  *frame_alloc      (size_t size);
+void  *frame_realloc    (void *memory, size_t old_size, size_t new_size);
+
+// The scratch arena is per-thread, and scoped: take a mark, allocate what
+// you need, then release back to the mark when finished. An arena that
+// hasn't needed more than a small cap for a couple of seconds gives the
+// rest back to the heap, so a one-off big job doesn't keep it for the life
+// of the thread.
+struct frame_mark_t {
+	int32_t block;
+	size_t  block_used;
+	size_t  used;
+};
+
+frame_mark_t frame_scratch_mark   ();
+void        *frame_scratch_alloc  (size_t size);
+void         frame_scratch_release(frame_mark_t mark);
+
+// High-water marks in bytes, for the stats
+size_t frame_alloc_peak  ();
+size_t frame_scratch_peak();
+
+void frame_alloc_end     ();
+void frame_alloc_shutdown();
+
+} // namespace sk
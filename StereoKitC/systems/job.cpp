@@ -0,0 +1,256 @@
+#include "job.h"
+#include "profiler.h"
+#include "../stereokit.h"
+#include "../libraries/array.h"
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct job_t {
+	void         (*func)      (void *data);
+	void         (*range_func)(void *data, int32_t start, int32_t end);
+	void          *data;
+	int32_t        start;
+	int32_t        end;
+	job_counter_t *counter;
+};
+
+// Each worker owns a queue. The owner takes its newest jobs from the back,
+// and idle workers steal the oldest ones from the front.
+struct job_queue_t {
+	std::mutex     lock;
+	array_t<job_t> jobs = {};
+	int32_t        head = 0;
+};
+
+struct job_worker_t {
+	std::thread thread;
+	job_queue_t queue;
+};
+
+///////////////////////////////////////////
+
+job_worker_t           *job_workers      = nullptr;
+int32_t                 job_worker_total = 0;
+bool                    job_running      = false;
+std::atomic<int32_t>    job_queued       = {0};
+std::atomic<uint32_t>   job_next_queue   = {0};
+std::mutex              job_sleep_lock;
+std::condition_variable job_sleep_signal;
+
+thread_local int32_t    job_worker_index = -1;
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "job_counter_t must be usable as an atomic");
+
+///////////////////////////////////////////
+
+void job_worker_run (int32_t index);
+bool job_try_run    (int32_t index);
+void job_push       (const job_t &job);
+void job_execute    (const job_t &job);
+
+///////////////////////////////////////////
+
+inline std::atomic<int32_t> *job_counter_atomic(job_counter_t *counter) {
+	return (std::atomic<int32_t>*)&counter->pending;
+}
+
+///////////////////////////////////////////
+
+bool job_init() {
+	// The main thread helps out whenever it waits, so it doesn't need a
+	// worker of its own.
+	job_worker_total = (int32_t)std::thread::hardware_concurrency() - 1;
+	if (job_worker_total < 0)
+		job_worker_total = 0;
+
+	job_running = true;
+	job_queued  = 0;
+	job_workers = job_worker_total > 0 ? new job_worker_t[job_worker_total] : nullptr;
+	for (int32_t i = 0; i < job_worker_total; i++)
+		job_workers[i].thread = std::thread(job_worker_run, i);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void job_shutdown() {
+	// Workers finish whatever is still queued before they exit
+	job_sleep_lock.lock();
+	job_running = false;
+	job_sleep_lock.unlock();
+	job_sleep_signal.notify_all();
+
+	for (int32_t i = 0; i < job_worker_total; i++) {
+		job_workers[i].thread.join();
+		job_workers[i].queue.jobs.free();
+	}
+	delete [] job_workers;
+	job_workers      = nullptr;
+	job_worker_total = 0;
+}
+
+///////////////////////////////////////////
+
+void job_worker_run(int32_t index) {
+	job_worker_index = index;
+	while (true) {
+		if (job_try_run(index))
+			continue;
+
+		std::unique_lock<std::mutex> lock(job_sleep_lock);
+		job_sleep_signal.wait(lock, []{ return job_queued > 0 || !job_running; });
+		if (!job_running && job_queued == 0)
+			break;
+	}
+}
+
+///////////////////////////////////////////
+
+bool job_try_run(int32_t index) {
+	if (job_queued == 0)
+		return false;
+
+	job_t job;
+	bool  found = false;
+
+	// Newest work from our own queue first, it's the most likely to still
+	// be in cache.
+	if (index >= 0) {
+		job_queue_t &queue = job_workers[index].queue;
+		queue.lock.lock();
+		if (queue.jobs.count > queue.head) {
+			job   = queue.jobs.last();
+			found = true;
+			queue.jobs.pop();
+			if (queue.jobs.count == queue.head) {
+				queue.jobs.clear();
+				queue.head = 0;
+			}
+		}
+		queue.lock.unlock();
+	}
+
+	// Then steal the oldest work from everyone else
+	for (int32_t i = 1; !found && i <= job_worker_total; i++) {
+		job_queue_t &queue = job_workers[(index + i + job_worker_total) % job_worker_total].queue;
+		queue.lock.lock();
+		if (queue.jobs.count > queue.head) {
+			job   = queue.jobs[queue.head];
+			found = true;
+			queue.head += 1;
+			if (queue.jobs.count == queue.head) {
+				queue.jobs.clear();
+				queue.head = 0;
+			}
+		}
+		queue.lock.unlock();
+	}
+
+	if (!found)
+		return false;
+
+	job_queued -= 1;
+	job_execute(job);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void job_execute(const job_t &job) {
+	profile_zone("job");
+	if (job.func != nullptr) job.func      (job.data);
+	else                     job.range_func(job.data, job.start, job.end);
+
+	if (job.counter != nullptr)
+		*job_counter_atomic(job.counter) -= 1;
+}
+
+///////////////////////////////////////////
+
+void job_push(const job_t &job) {
+	if (job.counter != nullptr)
+		*job_counter_atomic(job.counter) += 1;
+
+	// Without any workers, there's nobody to hand the job off to
+	if (job_worker_total == 0) {
+		job_execute(job);
+		return;
+	}
+
+	// Workers keep their own work close, everyone else spreads it around
+	int32_t      index = job_worker_index >= 0
+		? job_worker_index
+		: (int32_t)(job_next_queue++ % (uint32_t)job_worker_total);
+	job_queue_t &queue = job_workers[index].queue;
+	queue.lock.lock();
+	queue.jobs.add(job);
+	queue.lock.unlock();
+
+	// Taking the sleep lock makes sure a worker that's about to sleep
+	// sees this job first.
+	job_sleep_lock.lock();
+	job_queued += 1;
+	job_sleep_lock.unlock();
+	job_sleep_signal.notify_one();
+}
+
+///////////////////////////////////////////
+
+void job_submit(void (*job)(void *data), void *data, job_counter_t *counter) {
+	job_t item = {};
+	item.func    = job;
+	item.data    = data;
+	item.counter = counter;
+	job_push(item);
+}
+
+///////////////////////////////////////////
+
+void job_parallel_for(int32_t start, int32_t end, int32_t batch_size, void (*job)(void *data, int32_t start, int32_t end), void *data, job_counter_t *counter) {
+	int32_t count = end - start;
+	if (count <= 0)
+		return;
+
+	// A few batches per thread leaves room for stealing to even things out
+	if (batch_size <= 0) {
+		int32_t batches = (job_worker_total + 1) * 4;
+		batch_size = (count + batches - 1) / batches;
+		if (batch_size < 1)
+			batch_size = 1;
+	}
+
+	job_t item = {};
+	item.range_func = job;
+	item.data       = data;
+	item.counter    = counter;
+	for (int32_t i = start; i < end; i += batch_size) {
+		item.start = i;
+		item.end   = end - i < batch_size ? end : i + batch_size;
+		job_push(item);
+	}
+}
+
+///////////////////////////////////////////
+
+void job_wait(job_counter_t *counter) {
+	// Rather than sit idle, help out with whatever work is available
+	while (*job_counter_atomic(counter) > 0) {
+		if (!job_try_run(job_worker_index))
+			std::this_thread::yield();
+	}
+}
+
+///////////////////////////////////////////
+
+int32_t job_worker_count() {
+	return job_worker_total;
+}
+
+} // namespace sk
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace sk {
+
+bool job_init    ();
+void job_shutdown();
+
+} // namespace sk
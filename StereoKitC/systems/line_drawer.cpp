@@ -3,6 +3,7 @@
 #include "../shaders_builtin/shader_builtin.h"
 #include "../math.h"
 #include "../hierarchy.h"
+#include "frame_alloc.h"
 
 #include <stdlib.h>
 
@@ -37,11 +38,16 @@ bool line_drawer_init() {
 ///////////////////////////////////////////
 
 void line_drawer_update() {
+	// The frame arena takes these back at the end of the frame
+	vert_t *verts = line_verts;
+	vind_t *inds  = line_inds;
+	line_verts = nullptr;
+	line_inds  = nullptr;
 	if (line_ind_ct <= 0)
 		return;
 
-	mesh_set_verts    (line_mesh, line_verts, line_vert_cap, false);
-	mesh_set_inds     (line_mesh, line_inds,  line_ind_cap);
+	mesh_set_verts    (line_mesh, verts, line_vert_cap, false);
+	mesh_set_inds     (line_mesh, inds,  line_ind_cap);
 	mesh_set_draw_inds(line_mesh, line_ind_ct);
 	render_add_mesh   (line_mesh, line_material, matrix_identity);
 
@@ -59,14 +65,21 @@ void line_drawer_shutdown() {
 ///////////////////////////////////////////
 
 void line_ensure_cap(int32_t verts, int32_t inds) {
+	// Line data only lives for the frame, but starts out at the capacity
+	// from previous frames, so it rarely needs to grow.
+	if (line_verts == nullptr && line_vert_cap > 0) line_verts = (vert_t*)frame_alloc(line_vert_cap * sizeof(vert_t));
+	if (line_inds  == nullptr && line_ind_cap  > 0) line_inds  = (vind_t*)frame_alloc(line_ind_cap  * sizeof(vind_t));
+
 	if (line_vert_ct + verts >= line_vert_cap) {
+		uint32_t old_cap = line_vert_cap;
 		line_vert_cap = maxi(line_vert_ct + verts, line_vert_cap * 2);
-		line_verts    = (vert_t*)realloc(line_verts, line_vert_cap * sizeof(vert_t));
+		line_verts    = (vert_t*)frame_realloc(line_verts, old_cap * sizeof(vert_t), line_vert_cap * sizeof(vert_t));
 	}
 
 	if (line_ind_ct + inds >= line_ind_cap) {
+		uint32_t old_cap = line_ind_cap;
 		line_ind_cap = maxi(line_ind_ct + inds, line_ind_cap * 2);
-		line_inds    = (vind_t*)realloc(line_inds, line_ind_cap * sizeof(vind_t));
+		line_inds    = (vind_t*)frame_realloc(line_inds, old_cap * sizeof(vind_t), line_ind_cap * sizeof(vind_t));
 	}
 }
 
@@ -0,0 +1,214 @@
+#include "memory_track.h"
+#include "../_stereokit.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <atomic>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Sits in front of each tracked allocation. 16 bytes keeps the memory
+// after it aligned the same way malloc's is.
+struct memory_header_t {
+	size_t   size;
+	uint32_t tag;
+	uint32_t check;
+};
+
+struct memory_counter_t {
+	std::atomic<int64_t> live_bytes;
+	std::atomic<int64_t> peak_bytes;
+	std::atomic<int64_t> live_count;
+	std::atomic<int64_t> total_count;
+};
+
+///////////////////////////////////////////
+
+const uint32_t          memory_check        = 0x534b4d45;
+const char             *memory_tag_names[]  = { "General", "Mesh", "Tex", "Shader", "Material", "Model", "Font", "Sprite", "Sound", "Render", "Text", "UI", "Audio", "Physics", "Log" };
+memory_counter_t        memory_counters[memory_tag_max] = {};
+thread_local memory_tag_ memory_tag_current = memory_tag_general;
+
+float                   memory_dump_interval = 0;
+double                  memory_dump_last     = 0;
+
+///////////////////////////////////////////
+
+void memory_track_alloc(memory_tag_ tag, size_t size) {
+#ifndef SK_NO_MEMORY_TRACKING
+	memory_counter_t &counter = memory_counters[tag];
+	int64_t live = counter.live_bytes.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+	counter.live_count .fetch_add(1, std::memory_order_relaxed);
+	counter.total_count.fetch_add(1, std::memory_order_relaxed);
+
+	int64_t peak = counter.peak_bytes.load(std::memory_order_relaxed);
+	while (peak < live && !counter.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+#endif
+}
+
+///////////////////////////////////////////
+
+void memory_track_release(memory_tag_ tag, size_t size) {
+#ifndef SK_NO_MEMORY_TRACKING
+	memory_counter_t &counter = memory_counters[tag];
+	counter.live_bytes.fetch_sub((int64_t)size, std::memory_order_relaxed);
+	counter.live_count.fetch_sub(1,             std::memory_order_relaxed);
+#endif
+}
+
+///////////////////////////////////////////
+
+memory_tag_ memory_current_tag() {
+	return memory_tag_current;
+}
+
+///////////////////////////////////////////
+
+memory_tag_ memory_scope_push(memory_tag_ tag) {
+	memory_tag_ previous = memory_tag_current;
+	memory_tag_current = tag;
+	return previous;
+}
+
+///////////////////////////////////////////
+
+void memory_scope_pop(memory_tag_ previous) {
+	memory_tag_current = previous;
+}
+
+///////////////////////////////////////////
+
+void *sk_malloc(size_t size) {
+#ifndef SK_NO_MEMORY_TRACKING
+	memory_header_t *header = (memory_header_t *)malloc(sizeof(memory_header_t) + size);
+	if (header == nullptr)
+		return nullptr;
+	header->size  = size;
+	header->tag   = memory_tag_current;
+	header->check = memory_check;
+	memory_track_alloc(memory_tag_current, size);
+	return header + 1;
+#else
+	return malloc(size);
+#endif
+}
+
+///////////////////////////////////////////
+
+void *sk_calloc(size_t count, size_t size) {
+	void *result = sk_malloc(count * size);
+	if (result != nullptr)
+		memset(result, 0, count * size);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void *sk_realloc(void *memory, size_t size) {
+#ifndef SK_NO_MEMORY_TRACKING
+	if (memory == nullptr)
+		return sk_malloc(size);
+
+	// Reallocations keep the tag they were first allocated with
+	memory_header_t *header = (memory_header_t *)memory - 1;
+	assert(header->check == memory_check);
+	memory_tag_ tag      = (memory_tag_)header->tag;
+	size_t      old_size = header->size;
+
+	memory_header_t *result = (memory_header_t *)realloc(header, sizeof(memory_header_t) + size);
+	if (result == nullptr)
+		return nullptr;
+	result->size = size;
+	memory_track_release(tag, old_size);
+	memory_track_alloc  (tag, size);
+	return result + 1;
+#else
+	return realloc(memory, size);
+#endif
+}
+
+///////////////////////////////////////////
+
+void sk_free(void *memory) {
+#ifndef SK_NO_MEMORY_TRACKING
+	if (memory == nullptr)
+		return;
+	memory_header_t *header = (memory_header_t *)memory - 1;
+	assert(header->check == memory_check);
+	header->check = 0;
+	memory_track_release((memory_tag_)header->tag, header->size);
+	free(header);
+#else
+	free(memory);
+#endif
+}
+
+///////////////////////////////////////////
+
+memory_stats_t sk_memory_stats(memory_tag_ tag) {
+	if (tag < 0 || tag >= memory_tag_max) {
+		log_errf("sk_memory_stats: %d isn't a valid memory tag!", tag);
+		return {};
+	}
+	memory_counter_t &counter = memory_counters[tag];
+	return memory_stats_t {
+		counter.live_bytes .load(std::memory_order_relaxed),
+		counter.peak_bytes .load(std::memory_order_relaxed),
+		counter.live_count .load(std::memory_order_relaxed),
+		counter.total_count.load(std::memory_order_relaxed) };
+}
+
+///////////////////////////////////////////
+
+const char *sk_memory_tag_name(memory_tag_ tag) {
+	return tag >= 0 && tag < memory_tag_max
+		? memory_tag_names[tag]
+		: "Unknown";
+}
+
+///////////////////////////////////////////
+
+void sk_memory_dump() {
+	log_info("Memory by subsystem:");
+	log_info("<~BLK>_____________________________________________________________<~clr>");
+	log_info("<~BLK>|<~clr>      <~YLW>Tag <~BLK>|<~clr>      <~YLW>Live <~BLK>|<~clr>      <~YLW>Peak <~BLK>|<~clr>  <~YLW>Allocs <~BLK>|<~clr>      <~YLW>Total <~BLK>|<~clr>");
+	log_info("<~BLK>|__________|___________|___________|__________|____________|<~clr>");
+	for (int32_t i = 0; i < memory_tag_max; i++) {
+		memory_stats_t stats = sk_memory_stats((memory_tag_)i);
+		if (stats.total_count == 0)
+			continue;
+		log_infof("<~BLK>|<~CYN>%9s <~BLK>|<~clr> %7.1f<~BLK>KB<~clr> <~BLK>|<~clr> %7.1f<~BLK>KB<~clr> <~BLK>|<~clr> %8lld <~BLK>|<~clr> %10lld <~BLK>|<~clr>",
+			memory_tag_names[i], stats.live_bytes / 1024.0, stats.peak_bytes / 1024.0,
+			(long long)stats.live_count, (long long)stats.total_count);
+	}
+	log_info("<~BLK>|__________|___________|___________|__________|____________|<~clr>");
+}
+
+///////////////////////////////////////////
+
+void sk_set_memory_dump_interval(float seconds) {
+	memory_dump_interval = seconds;
+	memory_dump_last     = sk_timev;
+}
+
+///////////////////////////////////////////
+
+void memory_update() {
+	if (memory_dump_interval <= 0 || sk_timev - memory_dump_last < memory_dump_interval)
+		return;
+	memory_dump_last = sk_timev;
+	sk_memory_dump();
+}
+
+///////////////////////////////////////////
+
+void memory_shutdown() {
+	// Sessions that dump as they go get one last look at the end
+	if (memory_dump_interval > 0)
+		sk_memory_dump();
+}
+
+} // namespace sk
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../stereokit.h"
+#include <stddef.h>
+
+namespace sk {
+
+// Engine allocations go through these, so each allocation can be counted
+// against the subsystem that made it. The tag comes from the innermost
+// memory_scope on the current thread, and is stored with the allocation,
+// so it gets freed from the same tag no matter where that happens.
+void *sk_malloc (size_t size);
+void *sk_calloc (size_t count, size_t size);
+void *sk_realloc(void *memory, size_t size);
+void  sk_free   (void *memory);
+
+// For allocators that track their own sizes, like the physics engine's
+memory_tag_ memory_current_tag  ();
+void        memory_track_alloc  (memory_tag_ tag, size_t size);
+void        memory_track_release(memory_tag_ tag, size_t size);
+
+memory_tag_ memory_scope_push(memory_tag_ tag);
+void        memory_scope_pop (memory_tag_ previous);
+
+struct memory_scope_t {
+	memory_tag_ previous;
+	memory_scope_t(memory_tag_ tag) { previous = memory_scope_push(tag); }
+	~memory_scope_t()               { memory_scope_pop(previous); }
+};
+
+#ifndef SK_NO_MEMORY_TRACKING
+#define SK_MEMORY_JOIN2(a, b) a##b
+#define SK_MEMORY_JOIN(a, b) SK_MEMORY_JOIN2(a, b)
+#define memory_scope(tag) sk::memory_scope_t SK_MEMORY_JOIN(_memory_scope_, __LINE__)(tag)
+#else
+#define memory_scope(tag)
+#endif
+
+void memory_update  ();
+void memory_shutdown();
+
+} // namespace sk
@@ -1,6 +1,8 @@
 #pragma comment(lib, "reactphysics3d.lib")
 
 #include "physics.h"
+#include "profiler.h"
+#include "memory_track.h"
 #include "../stereokit.h"
 #include "../_stereokit.h"
 #include "../libraries/array.h"
@@ -8,6 +10,7 @@
 #pragma warning(push)
 #pragma warning( disable: 4244 4267 4100 )
 #include <reactphysics3d.h>
+#include <memory/MemoryManager.h>
 using namespace reactphysics3d;
 #pragma warning(pop)
 
@@ -37,9 +40,27 @@ DynamicsWorld *physics_world;
 
 array_t<physics_shape_asset_t> physics_shapes = {};
 
+// The physics engine tells us the size when releasing memory, so this can
+// count its allocations without needing a header on them.
+class physics_allocator_t : public MemoryAllocator {
+public:
+	void *allocate(size_t size) override {
+		memory_track_alloc(memory_tag_physics, size);
+		return malloc(size);
+	}
+	void release(void *pointer, size_t size) override {
+		memory_track_release(memory_tag_physics, size);
+		free(pointer);
+	}
+};
+physics_allocator_t physics_allocator;
+MemoryAllocator    *physics_allocator_prev = nullptr;
+
 ///////////////////////////////////////////
 
 bool physics_init() {
+	physics_allocator_prev = &MemoryManager::getBaseAllocator();
+	MemoryManager::setBaseAllocator(&physics_allocator);
 
 	WorldSettings settings;
 	physics_world = new DynamicsWorld(Vector3(0,-9.81f,0), settings);
@@ -53,6 +74,10 @@ void physics_shutdown() {
 	physics_shapes.free();
 
 	delete physics_world;
+
+	// The engine's static allocators outlive us, so hand them back their
+	// original allocator.
+	MemoryManager::setBaseAllocator(physics_allocator_prev);
 }
 
 ///////////////////////////////////////////
@@ -89,6 +114,7 @@ void physics_update() {
 
 	// Sim physics!
 	while (physics_sim_time < sk_timev) {
+		profile_zone("physics_step");
 		physics_world->update((reactphysics3d::decimal)physics_step);
 		physics_sim_time += physics_step;
 	}
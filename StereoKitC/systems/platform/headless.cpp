@@ -0,0 +1,54 @@
+#include "headless.h"
+
+#include "../../stereokit.h"
+#include "../../_stereokit.h"
+#include "../render.h"
+#include "../d3d.h"
+#include "../input.h"
+
+namespace sk {
+
+///////////////////////////////////////////
+
+bool headless_init(const char *app_name) {
+	sk_info.display_width  = sk_settings.flatscreen_width;
+	sk_info.display_height = sk_settings.flatscreen_height;
+	sk_info.display_type   = display_opaque;
+	sk_focused             = true;
+
+	// Assets still need a device to create their resources on, but nothing
+	// here ever gets presented, so a software device is plenty. Drawing
+	// goes to the null backend, which just validates the command stream.
+	if (!d3d_init(nullptr, true))
+		return false;
+	render_set_backend(render_backend_null);
+
+	log_diagf("Running %s headless", app_name);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void headless_shutdown() {
+	d3d_shutdown();
+}
+
+///////////////////////////////////////////
+
+void headless_step_begin() {
+	d3d_update();
+}
+
+///////////////////////////////////////////
+
+void headless_step_end() {
+	input_update_predicted();
+
+	matrix view = render_get_cam_root  ();
+	matrix proj = render_get_projection();
+	matrix_inverse(view, view);
+	render_draw_matrix(&view, &proj, 1);
+	render_clear();
+}
+
+} // namespace sk
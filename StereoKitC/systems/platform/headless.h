@@ -0,0 +1,10 @@
+#pragma once
+
+namespace sk {
+
+bool headless_init      (const char *app_name);
+void headless_shutdown  ();
+void headless_step_begin();
+void headless_step_end  ();
+
+} // namespace sk
@@ -4,6 +4,7 @@
 #include "win32.h"
 #include "uwp.h"
 #include "openxr.h"
+#include "headless.h"
 
 namespace sk {
 
@@ -17,6 +18,10 @@ bool platform_init() {
 	}
 #endif
 	
+	// Headless doesn't fall back to anything, it's only for automated runs
+	if (sk_runtime == runtime_headless)
+		return headless_init(sk_app_name);
+
 	// Create a runtime
 	bool result = sk_runtime == runtime_mixedreality ?
 		openxr_init(sk_app_name) :
@@ -60,6 +65,7 @@ void platform_shutdown() {
 #endif
 #endif
 	case runtime_mixedreality: openxr_shutdown(); break;
+	case runtime_headless:     headless_shutdown(); break;
 	}
 }
 
@@ -75,6 +81,7 @@ void platform_begin_frame() {
 #endif
 #endif
 	case runtime_mixedreality: openxr_step_begin(); break;
+	case runtime_headless:     headless_step_begin(); break;
 	}
 }
 
@@ -90,6 +97,7 @@ void platform_end_frame() {
 #endif
 #endif
 	case runtime_mixedreality: openxr_step_end(); break;
+	case runtime_headless:     headless_step_end(); break;
 	}
 }
 
@@ -105,6 +113,7 @@ void platform_present() {
 #endif
 #endif
 	case runtime_mixedreality: break;
+	case runtime_headless:     break;
 	}
 }
 
@@ -0,0 +1,323 @@
+#include "profiler.h"
+#include "../stereokit.h"
+#include "../libraries/array.h"
+#include "../libraries/stref.h"
+
+#include <stdio.h>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+using namespace std::chrono;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct profiler_event_t {
+	const char *name;
+	int64_t     start;
+	int64_t     end;
+};
+
+struct profiler_open_t {
+	const char *name;
+	int64_t     start;
+};
+
+// Each thread records into its own buffer, so the only contention is with
+// the thread that writes the capture out.
+struct profiler_thread_t {
+	std::mutex                lock;
+	array_t<profiler_event_t> events;
+	int32_t                   id;
+	const char               *name;
+	profiler_open_t           open[64];
+	int32_t                   depth;
+	bool                      exited;
+};
+
+// Lets a thread hand its buffer back when it exits
+struct profiler_thread_local_t {
+	profiler_thread_t *thread     = nullptr;
+	uint32_t           generation = 0;
+	~profiler_thread_local_t();
+};
+
+///////////////////////////////////////////
+
+array_t<profiler_thread_t*>          profiler_threads          = {};
+std::mutex                           profiler_threads_lock;
+int32_t                              profiler_threads_next_id  = 0;
+// Bumped on shutdown, which frees every thread's buffer, so threads that
+// outlive it know to make a new one.
+uint32_t                             profiler_generation       = 1;
+thread_local profiler_thread_local_t profiler_thread_local;
+
+std::atomic<bool>                profiler_active        = {false};
+time_point<high_resolution_clock> profiler_epoch;
+char                            *profiler_filename      = nullptr;
+int32_t                          profiler_frames_left   = 0;
+bool                             profiler_requested     = false;
+
+///////////////////////////////////////////
+
+void profiler_write();
+
+///////////////////////////////////////////
+
+inline int64_t profiler_now() {
+	return duration_cast<nanoseconds>(high_resolution_clock::now() - profiler_epoch).count();
+}
+
+///////////////////////////////////////////
+
+profiler_thread_t *profiler_get_thread() {
+	profiler_thread_local_t &local = profiler_thread_local;
+	if (local.thread == nullptr || local.generation != profiler_generation) {
+		profiler_thread_t *thread = new profiler_thread_t();
+		thread->events = {};
+		thread->name   = nullptr;
+		thread->depth  = 0;
+		thread->exited = false;
+		profiler_threads_lock.lock();
+		thread->id = profiler_threads_next_id++;
+		profiler_threads.add(thread);
+		local.thread     = thread;
+		local.generation = profiler_generation;
+		profiler_threads_lock.unlock();
+	}
+	return local.thread;
+}
+
+///////////////////////////////////////////
+
+// Returns the calling thread's buffer if it has a live one, without
+// making one.
+inline profiler_thread_t *profiler_find_thread() {
+	return profiler_thread_local.generation == profiler_generation
+		? profiler_thread_local.thread
+		: nullptr;
+}
+
+///////////////////////////////////////////
+
+void profiler_thread_free(int32_t index) {
+	delete profiler_threads[index];
+	profiler_threads.remove(index);
+}
+
+///////////////////////////////////////////
+
+profiler_thread_local_t::~profiler_thread_local_t() {
+	profiler_threads_lock.lock();
+	if (thread != nullptr && generation == profiler_generation) {
+		// Events that haven't been written yet still belong in the capture,
+		// so those buffers stick around until the next write.
+		thread->lock.lock();
+		bool empty = thread->events.count == 0;
+		thread->exited = true;
+		thread->lock.unlock();
+		for (int32_t i = 0; empty && i < profiler_threads.count; i++) {
+			if (profiler_threads[i] == thread) {
+				thread->events.free();
+				profiler_thread_free(i);
+				break;
+			}
+		}
+	}
+	thread = nullptr;
+	profiler_threads_lock.unlock();
+}
+
+///////////////////////////////////////////
+
+void profiler_thread_name(const char *name) {
+	profiler_get_thread()->name = name;
+}
+
+///////////////////////////////////////////
+
+void profiler_zone_push(const char *name) {
+	if (!profiler_active.load(std::memory_order_relaxed))
+		return;
+
+	profiler_thread_t *thread = profiler_get_thread();
+	if (thread->depth < _countof(thread->open))
+		thread->open[thread->depth] = { name, profiler_now() };
+	thread->depth += 1;
+}
+
+///////////////////////////////////////////
+
+void profiler_zone_pop() {
+	// Zones that started before the capture did have nothing to close
+	profiler_thread_t *thread = profiler_find_thread();
+	if (thread == nullptr || thread->depth == 0)
+		return;
+
+	thread->depth -= 1;
+	if (thread->depth >= _countof(thread->open) || !profiler_active.load(std::memory_order_relaxed))
+		return;
+
+	const profiler_open_t &open = thread->open[thread->depth];
+	thread->lock.lock();
+	thread->events.add({ open.name, open.start, profiler_now() });
+	thread->lock.unlock();
+}
+
+///////////////////////////////////////////
+
+void profiler_zone_begin(const char *name) {
+	profiler_zone_push(name);
+}
+
+///////////////////////////////////////////
+
+void profiler_zone_end() {
+	profiler_zone_pop();
+}
+
+///////////////////////////////////////////
+
+void profiler_capture(int32_t frame_count, const char *filename) {
+	if (profiler_active || profiler_requested) {
+		log_warn("profiler_capture: A capture is already in progress!");
+		return;
+	}
+	if (frame_count <= 0 || filename == nullptr) {
+		log_err("profiler_capture: Needs a filename, and at least one frame to capture!");
+		return;
+	}
+	profiler_filename    = string_copy(filename);
+	profiler_frames_left = frame_count;
+	profiler_requested   = true;
+}
+
+///////////////////////////////////////////
+
+bool32_t profiler_capturing() {
+	return profiler_active || profiler_requested;
+}
+
+///////////////////////////////////////////
+
+bool profiler_init() {
+	profiler_epoch = high_resolution_clock::now();
+
+	// Init runs on the main thread, this makes sure it's thread 0
+	profiler_get_thread();
+	return true;
+}
+
+///////////////////////////////////////////
+
+void profiler_shutdown() {
+	// Don't lose a capture that was cut short
+	if (profiler_active) {
+		profiler_active = false;
+		profiler_write();
+	}
+	profiler_requested = false;
+	free(profiler_filename);
+	profiler_filename = nullptr;
+
+	// Threads that are still running see the new generation, and make a
+	// fresh buffer if they ever record again.
+	profiler_threads_lock.lock();
+	for (int32_t i = 0; i < profiler_threads.count; i++) {
+		profiler_threads[i]->events.free();
+		delete profiler_threads[i];
+	}
+	profiler_threads.free();
+	profiler_threads_next_id  = 0;
+	profiler_generation      += 1;
+	profiler_threads_lock.unlock();
+}
+
+///////////////////////////////////////////
+
+void profiler_frame_begin() {
+	// Captures always start and stop on frame boundaries
+	if (profiler_requested) {
+		profiler_requested = false;
+		profiler_active    = true;
+	}
+	profiler_zone_push("Frame");
+}
+
+///////////////////////////////////////////
+
+void profiler_frame_end() {
+	profiler_zone_pop();
+	if (!profiler_active)
+		return;
+
+	profiler_frames_left -= 1;
+	if (profiler_frames_left <= 0) {
+		profiler_active = false;
+		profiler_write();
+	}
+}
+
+///////////////////////////////////////////
+
+void profiler_write_string(FILE *fp, const char *str) {
+	fputc('"', fp);
+	for (const char *c = str; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') fputc('\\', fp);
+		if ((unsigned char)*c >= 0x20) fputc(*c, fp);
+	}
+	fputc('"', fp);
+}
+
+///////////////////////////////////////////
+
+void profiler_write() {
+	FILE *fp = nullptr;
+	if (fopen_s(&fp, profiler_filename, "w") != 0 || fp == nullptr) {
+		log_errf("profiler_capture: Couldn't write capture to %s!", profiler_filename);
+	} else {
+		// Chrome's trace event format, this loads in Perfetto and in
+		// chrome://tracing. Timestamps are in microseconds.
+		int32_t event_count = 0;
+		fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		profiler_threads_lock.lock();
+		for (int32_t t = 0; t < profiler_threads.count; t++) {
+			profiler_thread_t *thread = profiler_threads[t];
+			const char        *name   = thread->name != nullptr ? thread->name : thread->id == 0 ? "Main" : "Worker";
+			fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+				t == 0 ? "" : ",\n", thread->id, name, thread->id);
+
+			thread->lock.lock();
+			for (int32_t e = 0; e < thread->events.count; e++) {
+				const profiler_event_t &evt = thread->events[e];
+				fprintf(fp, ",\n{\"name\":");
+				profiler_write_string(fp, evt.name);
+				fprintf(fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+					thread->id, evt.start / 1000.0, (evt.end - evt.start) / 1000.0);
+			}
+			event_count += thread->events.count;
+			thread->events.clear();
+			thread->lock.unlock();
+		}
+		profiler_threads_lock.unlock();
+		fprintf(fp, "\n]}\n");
+		fclose(fp);
+
+		log_infof("Profiler capture saved %d zones to %s", event_count, profiler_filename);
+	}
+
+	// Threads that exited mid-capture were only waiting on this write
+	profiler_threads_lock.lock();
+	for (int32_t i = profiler_threads.count - 1; i >= 0; i--) {
+		if (!profiler_threads[i]->exited) continue;
+		profiler_threads[i]->events.free();
+		profiler_thread_free(i);
+	}
+	profiler_threads_lock.unlock();
+
+	free(profiler_filename);
+	profiler_filename = nullptr;
+}
+
+} // namespace sk
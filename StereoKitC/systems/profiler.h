@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace sk {
+
+void profiler_zone_push  (const char *name);
+void profiler_zone_pop   ();
+// Names the calling thread in captures, name needs to stay valid.
+void profiler_thread_name(const char *name);
+
+// Scoped zones record from construction to destruction, and cost a single
+// flag check while no capture is running.
+struct profiler_zone_t {
+	profiler_zone_t(const char *name) { profiler_zone_push(name); }
+	~profiler_zone_t()                { profiler_zone_pop(); }
+};
+
+#ifndef SK_NO_PROFILER
+#define SK_PROFILE_JOIN2(a, b) a##b
+#define SK_PROFILE_JOIN(a, b) SK_PROFILE_JOIN2(a, b)
+#define profile_zone(name) sk::profiler_zone_t SK_PROFILE_JOIN(_profile_zone_, __LINE__)(name)
+#else
+#define profile_zone(name)
+#endif
+
+bool profiler_init       ();
+void profiler_shutdown   ();
+void profiler_frame_begin();
+void profiler_frame_end  ();
+
+} // namespace sk
@@ -1,5 +1,11 @@
 #include "render.h"
 #include "render_sort.h"
+#include "render_d3d11.h"
+#include "render_null.h"
+#include "render_cull.h"
+#include "render_occlusion.h"
+#include "profiler.h"
+#include "memory_track.h"
 #include "d3d.h"
 #include "../libraries/stref.h"
 #include "../math.h"
@@ -20,35 +26,58 @@
 #include <directxmath.h> // Matrix math functions and objects
 using namespace DirectX;
 
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+using namespace std::chrono;
+
 namespace sk {
 
 ///////////////////////////////////////////
 
-struct render_transform_buffer_t {
-	XMMATRIX world;
-	color128 color;
-	uint32_t view_id;
-};
-struct render_global_buffer_t {
-	XMMATRIX view[2];
-	XMMATRIX proj[2];
-	XMMATRIX viewproj[2];
-	vec4     lighting[9];
-	vec4     camera_pos[2];
-	vec4     camera_dir[2];
-	vec4     fingertip[2];
-	float    time;
+// Threads other than the main one submit into their own buffer, and these
+// get merged into the render list right before it's sorted and drawn.
+struct render_submit_buffer_t {
+	std::mutex                 lock;
+	array_t<render_item_t>     items;
+	array_t<render_occluder_t> occluders;
+	int32_t                    lod_counts[render_lod_stat_levels];
 };
-struct render_blit_data_t {
-	float width;
-	float height;
-	float pixel_width;
-	float pixel_height;
+
+///////////////////////////////////////////
+
+struct _render_instance_t {
+	model_t    model;
+	mesh_t     mesh;
+	material_t material;
+	XMMATRIX  *offsets;
+	int32_t    item_start;
+	int32_t    item_count;
 };
-struct render_inst_buffer {
-	size_t       max;
-	shaderargs_t buffer;
+
+///////////////////////////////////////////
+
+// Pipelined rendering hands the frame's list off to a render thread, which
+// culls, sorts and batches it while the next frame simulates. The backend
+// still executes it on the main thread, one frame later.
+struct render_pipeline_t {
+	std::thread             thread;
+	std::mutex              lock;
+	std::condition_variable signal;
+	bool                    running    = false;
+	bool                    job_ready  = false;
+	bool                    in_flight  = false;
+	bool                    prepared   = false;
+	render_list_t           list       = nullptr;
+	render_global_buffer_t  globals;
+	matrix                  views[2];
+	matrix                  projs[2];
+	int32_t                 view_count = 0;
 };
+
+///////////////////////////////////////////
+
 struct render_screenshot_t {
 	char *filename;
 	vec3  from;
@@ -59,14 +88,49 @@ struct render_screenshot_t {
 
 ///////////////////////////////////////////
 
-array_t<render_transform_buffer_t> render_instance_list = {};
-render_inst_buffer                 render_instance_buffers[] = { { 1 }, { 5 }, { 10 }, { 20 }, { 50 }, { 100 }, { 250 }, { 500 }, { 682 } };
-
-array_t<render_list_t> render_list_stack = {};
-array_t<render_list_t> render_lists      = {};
+render_backend_t render_backends[] = {
+	{ render_backend_d3d11,
+		render_d3d11_init,
+		render_d3d11_shutdown,
+		render_d3d11_begin_queue,
+		render_d3d11_execute,
+		render_d3d11_blit,
+		render_d3d11_target_begin,
+		render_d3d11_target_end },
+	{ render_backend_null,
+		render_null_init,
+		render_null_shutdown,
+		render_null_begin_queue,
+		render_null_execute,
+		render_null_blit,
+		render_null_target_begin,
+		render_null_target_end },
+};
+render_backend_t *render_backend             = &render_backends[0];
+bool              render_backend_initialized = false;
+
+array_t<render_list_t> render_list_stack   = {};
+array_t<render_list_t> render_lists        = {};
+render_list_t          render_list_primary = nullptr;
+uint64_t               render_frame_id     = 0;
+
+array_t<render_instance_t> render_instances     = {};
+render_list_t              render_instance_list = nullptr;
+
+array_t<render_submit_buffer_t*>      render_submit_buffers          = {};
+std::mutex                            render_submit_lock;
+thread_local render_submit_buffer_t  *render_submit_local            = nullptr;
+// Bumped on each init, so thread-locals left over from before a shutdown
+// don't hand back buffers that were freed along with it.
+uint32_t                              render_submit_generation       = 0;
+thread_local uint32_t                 render_submit_local_generation = 0;
+thread_local bool                     render_is_main_thread          = false;
+
+render_pipeline_t render_pipeline;
+bool32_t          render_pipelined   = false;
+render_stats_t    render_frame_stats = {};
+render_sort_      render_frame_sort  = render_sort_depth;
 
-shaderargs_t           render_shader_globals;
-shaderargs_t           render_shader_blit;
 matrix                 render_camera_root     = matrix_identity;
 matrix                 render_camera_root_inv = matrix_identity;
 matrix                 render_default_camera_proj;
@@ -85,14 +149,31 @@ material_t render_sky_mat     = nullptr;
 tex_t      render_sky_cubemap = nullptr;
 bool32_t   render_sky_show    = false;
 
-material_t render_last_material;
-shader_t   render_last_shader;
-mesh_t     render_last_mesh;
+thread_local material_t render_last_material;
+thread_local shader_t   render_last_shader;
+thread_local mesh_t     render_last_mesh;
 
 ///////////////////////////////////////////
 
-shaderargs_t *render_fill_inst_buffer(array_t<render_transform_buffer_t> &list, size_t &offset, size_t &out_count);
-void          render_check_screenshots();
+void render_check_screenshots(render_list_t list);
+bool render_prepare_queue    (render_list_t list, const matrix *views, const matrix *projections, int32_t view_count, render_global_buffer_t &globals);
+void render_submit_queue     (render_list_t list, const render_global_buffer_t &globals);
+void render_pipeline_thread  ();
+void render_pipeline_finish  ();
+void render_pipeline_stop    ();
+void render_emit_material    (render_list_t list, material_t material);
+void render_emit_mesh        (render_list_t list, mesh_t     mesh);
+void render_emit_draw        (render_list_t list, int32_t    start, int32_t count);
+void render_draw_occlusion   (render_list_t list, const render_item_t *items, const XMMATRIX *viewprojs, int32_t view_count);
+void render_build_commands   (render_list_t list, const render_item_t *items, const render_sort_key_t *order, int32_t count, int32_t view_count);
+void render_list_sort_retained(render_list_t list);
+void render_list_free_data   (render_list_t list);
+
+///////////////////////////////////////////
+
+inline float render_ms_since(time_point<high_resolution_clock> start) {
+	return (float)(duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0);
+}
 
 ///////////////////////////////////////////
 
@@ -207,7 +288,88 @@ color32 render_get_clear_color() {
 
 ///////////////////////////////////////////
 
+render_submit_buffer_t *render_submit_get_local() {
+	if (render_submit_local == nullptr || render_submit_local_generation != render_submit_generation) {
+		render_submit_local            = new render_submit_buffer_t();
+		render_submit_local_generation = render_submit_generation;
+		render_submit_lock.lock();
+		render_submit_buffers.add(render_submit_local);
+		render_submit_lock.unlock();
+	}
+	return render_submit_local;
+}
+
+///////////////////////////////////////////
+
+void render_submit_merge(render_list_t list) {
+	render_submit_lock.lock();
+	for (int32_t i = 0; i < render_submit_buffers.count; i++) {
+		render_submit_buffer_t *buffer = render_submit_buffers[i];
+		buffer->lock.lock();
+		if (buffer->items.count > 0) {
+			int32_t start = list->queue.count;
+			int32_t count = buffer->items.count;
+			if (list->queue.capacity < start + count)
+				list->queue.resize(start + count);
+			memcpy(&list->queue.data[start], buffer->items.data, sizeof(render_item_t) * count);
+			list->queue.count = start + count;
+			list->state       = render_list_state_used;
+			buffer->items.clear();
+		}
+		for (int32_t o = 0; o < buffer->occluders.count; o++) {
+			list->occluders.add(buffer->occluders[o]);
+			list->state = render_list_state_used;
+		}
+		buffer->occluders.clear();
+		for (int32_t l = 0; l < render_lod_stat_levels; l++) {
+			list->stats.lod_counts[l] += buffer->lod_counts[l];
+			buffer->lod_counts[l] = 0;
+		}
+		buffer->lock.unlock();
+	}
+	render_submit_lock.unlock();
+}
+
+///////////////////////////////////////////
+
+int32_t render_select_lod(const model_subset_t &subset, const XMMATRIX &world, int32_t current) {
+	// Approximate the subset's size on screen with the bounding sphere of
+	// the full detail mesh, seen from the head.
+	const bounds_t &bounds = subset.mesh->bounds;
+	XMVECTOR center = XMVector3Transform(XMLoadFloat3((XMFLOAT3*)&bounds.center), world);
+	float    scale  = fmaxf(XMVectorGetX(XMVector3LengthSq(world.r[0])), fmaxf(
+		XMVectorGetX(XMVector3LengthSq(world.r[1])),
+		XMVectorGetX(XMVector3LengthSq(world.r[2]))));
+	float    radius = vec3_magnitude(bounds.dimensions) * 0.5f * sqrtf(scale);
+	vec3     head   = input_head().position;
+	float    dist   = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, XMLoadFloat3((XMFLOAT3*)&head))));
+	float    size   = dist > radius
+		? radius / (dist * tanf(render_fov * deg2rad * 0.5f))
+		: 1;
+
+	// Without any history, just take the level from the thresholds
+	if (current < 0) {
+		int32_t level = 0;
+		while (level < subset.lod_count && size < subset.lods[level].screen_size)
+			level++;
+		return level;
+	}
+
+	// Otherwise, the size has to move past the threshold by a margin
+	// before switching, so objects right on the edge don't flicker.
+	const float hysteresis = 0.1f;
+	int32_t     level      = mini(current, subset.lod_count);
+	while (level < subset.lod_count && size < subset.lods[level].screen_size * (1 - hysteresis))
+		level++;
+	while (level > 0 && size > subset.lods[level - 1].screen_size * (1 + hysteresis))
+		level--;
+	return level;
+}
+
+///////////////////////////////////////////
+
 void render_add_mesh(mesh_t mesh, material_t material, const matrix &transform, color128 color) {
+	memory_scope(memory_tag_render);
 	render_item_t item;
 	item.mesh     = mesh;
 	item.material = material;
@@ -218,12 +380,47 @@ void render_add_mesh(mesh_t mesh, material_t material, const matrix &transform,
 	} else {
 		math_matrix_to_fast(transform, &item.transform);
 	}
-	render_list_stack.last()->queue.add(item);
+
+	if (render_is_main_thread) {
+		render_list_t list = render_list_stack.last();
+		list->queue.add(item);
+		list->state = render_list_state_used;
+	} else {
+		render_submit_buffer_t *buffer = render_submit_get_local();
+		buffer->lock.lock();
+		buffer->items.add(item);
+		buffer->lock.unlock();
+	}
+}
+
+///////////////////////////////////////////
+
+void render_add_occluder(mesh_t mesh, const matrix &transform) {
+	memory_scope(memory_tag_render);
+	render_occluder_t occluder;
+	occluder.mesh = mesh;
+	if (hierarchy_enabled) {
+		matrix_mul(transform, hierarchy_stack.last().transform, occluder.transform);
+	} else {
+		math_matrix_to_fast(transform, &occluder.transform);
+	}
+
+	if (render_is_main_thread) {
+		render_list_t list = render_list_stack.last();
+		list->occluders.add(occluder);
+		list->state = render_list_state_used;
+	} else {
+		render_submit_buffer_t *buffer = render_submit_get_local();
+		buffer->lock.lock();
+		buffer->occluders.add(occluder);
+		buffer->lock.unlock();
+	}
 }
 
 ///////////////////////////////////////////
 
 void render_add_model(model_t model, const matrix &transform, color128 color) {
+	memory_scope(memory_tag_render);
 	XMMATRIX root;
 	if (hierarchy_enabled) {
 		matrix_mul(transform, hierarchy_stack.last().transform, root);
@@ -231,28 +428,95 @@ void render_add_model(model_t model, const matrix &transform, color128 color) {
 		math_matrix_to_fast(transform, &root);
 	}
 
+	render_submit_buffer_t *buffer     = nullptr;
+	array_t<render_item_t> *queue      = nullptr;
+	int32_t                *lod_counts = nullptr;
+	if (render_is_main_thread) {
+		render_list_t list = render_list_stack.last();
+		list->state = render_list_state_used;
+		queue      = &list->queue;
+		lod_counts = list->stats.lod_counts;
+	} else {
+		buffer = render_submit_get_local();
+		queue      = &buffer->items;
+		lod_counts = buffer->lod_counts;
+		buffer->lock.lock();
+	}
+
+	// LOD hysteresis state is only kept for the main thread, worker
+	// threads just pick straight from the thresholds.
+	uint8_t *lod_state = nullptr;
+	if (model->has_lods && render_is_main_thread)
+		lod_state = model_lod_state(model, render_frame_id, matrix_mul_point(root, vec3_zero));
+
 	for (int i = 0; i < model->subset_count; i++) {
+		const model_subset_t &subset = model->subsets[i];
+
 		render_item_t item;
-		item.mesh     = model->subsets[i].mesh;
-		item.material = model->subsets[i].material;
+		item.material = subset.material;
 		item.color    = color;
-		item.sort_id  = render_queue_id(item.material, item.mesh);
-		matrix_mul(model->subsets[i].offset, root, item.transform);
-		render_list_stack.last()->queue.add(item);
+		matrix_mul(subset.offset, root, item.transform);
+
+		item.mesh = subset.mesh;
+		if (subset.lod_count > 0) {
+			int32_t level = render_select_lod(subset, item.transform, lod_state && lod_state[i] != model_lod_none ? lod_state[i] : -1);
+			if (lod_state) lod_state[i] = (uint8_t)level;
+			if (level > 0) item.mesh = subset.lods[level - 1].mesh;
+			lod_counts[mini(level, render_lod_stat_levels - 1)] += 1;
+		}
+		item.sort_id = render_queue_id(item.material, item.mesh);
+		queue->add(item);
 	}
+
+	if (buffer != nullptr)
+		buffer->lock.unlock();
 }
 
 ///////////////////////////////////////////
 
-void render_draw_queue(const matrix *views, const matrix *projections, int32_t view_count) {
-	
-	render_list_t render_list = render_list_stack.last();
-	size_t        queue_size  = render_list->queue.count;
-	if (queue_size == 0 || view_count == 0) return;
+void render_fill_globals(render_global_buffer_t &globals) {
+	memcpy(globals.lighting, render_lighting, sizeof(vec4) * 9);
+	globals.time = time_getf();
+
+	vec3 tip = input_hand(handed_right).tracked_state & button_state_active ? input_hand(handed_right).fingers[1][4].position : vec3{0,-1000,0};
+	globals.fingertip[0] = { tip.x, tip.y, tip.z, 0 };
+	tip = input_hand(handed_left).tracked_state & button_state_active ? input_hand(handed_left).fingers[1][4].position : vec3{0,-1000,0};
+	globals.fingertip[1] = { tip.x, tip.y, tip.z, 0 };
+}
 
-	radix_sort7(&render_list->queue[0], queue_size);
+///////////////////////////////////////////
+
+void render_draw_queue(render_list_t list, const matrix *views, const matrix *projections, int32_t view_count) {
+	if (list->queue.count == 0 || view_count == 0) return;
+
+	render_fill_globals(render_global_buffer);
+	if (render_prepare_queue(list, views, projections, view_count, render_global_buffer))
+		render_submit_queue(list, render_global_buffer);
+}
+
+///////////////////////////////////////////
+
+void render_submit_queue(render_list_t list, const render_global_buffer_t &globals) {
+	profile_zone("render_submit");
+	time_point<high_resolution_clock> start = high_resolution_clock::now();
+	render_backend->begin_queue(globals, render_sky_cubemap);
+	render_backend->execute(
+		list->commands .data, list->commands .count,
+		list->instances.data, list->instances.count);
+	list->stats.ms_submit += render_ms_since(start);
+}
+
+///////////////////////////////////////////
+
+bool render_prepare_queue(render_list_t list, const matrix *views, const matrix *projections, int32_t view_count, render_global_buffer_t &globals) {
+	// This can run on the render thread, so it only touches the list, and
+	// the camera portion of the globals.
+	int32_t queue_size = list->queue.count;
+	if (queue_size == 0 || view_count == 0) return false;
+	profile_zone("render_prepare");
 
 	// Copy camera information into the global buffer
+	XMMATRIX viewprojs[2];
 	for (int32_t i = 0; i < view_count; i++) {
 		XMMATRIX view_f, projection_f;
 		math_matrix_to_fast(views[i],       &view_f);
@@ -262,54 +526,175 @@ void render_draw_queue(const matrix *views, const matrix *projections, int32_t v
 
 		XMVECTOR cam_pos = XMVector3Transform(DirectX::g_XMIdentityR3, view_inv);
 		XMVECTOR cam_dir = XMVector3TransformNormal(DirectX::g_XMNegIdentityR2, view_inv);
-		XMStoreFloat3((XMFLOAT3*)&render_global_buffer.camera_pos[i], cam_pos);
-		XMStoreFloat3((XMFLOAT3*)&render_global_buffer.camera_dir[i], cam_dir);
+		XMStoreFloat3((XMFLOAT3*)&globals.camera_pos[i], cam_pos);
+		XMStoreFloat3((XMFLOAT3*)&globals.camera_dir[i], cam_dir);
 
-		render_global_buffer.view[i] = XMMatrixTranspose(view_f);
-		render_global_buffer.proj[i] = XMMatrixTranspose(projection_f);
-		render_global_buffer.viewproj[i] = XMMatrixTranspose(view_f * projection_f);
+		viewprojs[i] = view_f * projection_f;
+		globals.view[i] = XMMatrixTranspose(view_f);
+		globals.proj[i] = XMMatrixTranspose(projection_f);
+		globals.viewproj[i] = XMMatrixTranspose(viewprojs[i]);
 	}
-	memcpy(render_global_buffer.lighting, render_lighting, sizeof(vec4) * 9);
-	render_global_buffer.time = time_getf();
 
-	vec3 tip = input_hand(handed_right).tracked_state & button_state_active ? input_hand(handed_right).fingers[1][4].position : vec3{0,-1000,0};
-	render_global_buffer.fingertip[0] = { tip.x, tip.y, tip.z, 0 };
-	tip = input_hand(handed_left).tracked_state & button_state_active ? input_hand(handed_left).fingers[1][4].position : vec3{0,-1000,0};
-	render_global_buffer.fingertip[1] = { tip.x, tip.y, tip.z, 0 };
+	render_sort_scratch_t &scratch = list->sort_scratch;
+	if (scratch.keys.capacity < queue_size)
+		scratch.keys.resize(queue_size);
+
+	// Depth sorting goes off the average of the view positions, which
+	// works well enough for both eyes of a stereo pair.
+	render_cull_depth_t  depth_info = {};
+	render_cull_depth_t *depth      = nullptr;
+	if (list->sort == render_sort_depth) {
+		for (int32_t i = 0; i < view_count; i++)
+			depth_info.cam_pos = XMVectorAdd(depth_info.cam_pos, XMLoadFloat3((XMFLOAT3*)&globals.camera_pos[i]));
+		depth_info.cam_pos   = XMVectorScale(depth_info.cam_pos, 1.0f / view_count);
+		depth_info.cam_dir   = XMLoadFloat3((XMFLOAT3*)&globals.camera_dir[0]);
+		depth_info.far_plane = render_clip_planes.y;
+		depth = &depth_info;
+	}
 
-	shaderargs_set_data  (render_shader_globals, &render_global_buffer);
-	shaderargs_set_active(render_shader_globals);
-	d3d_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	const render_item_t *items   = nullptr;
+	bool                 rebuild = true;
+	time_point<high_resolution_clock> start;
+
+	// Stats describe the latest pass over the list, so drawing it again
+	// for another view or a screenshot doesn't pile onto them.
+	list->stats.ms_cull      = 0;
+	list->stats.ms_occlusion = 0;
+	list->stats.ms_sort      = 0;
+	list->stats.ms_instances = 0;
+	list->stats.ms_submit    = 0;
+
+	if (list->retained) {
+		// Retained lists sort everything once, and keep that order around
+		// until the list changes. Culling the sorted items keeps them in
+		// order, and if the same items are visible as last time, we can
+		// just re-submit the commands we already have. Depth sorted lists
+		// need re-sorting for each set of views, but unless the order
+		// actually changes, the commands are still reused.
+		start = high_resolution_clock::now();
+		if (list->state != render_list_state_rendered)
+			render_list_sort_retained(list);
+		list->stats.ms_sort += render_ms_since(start);
+
+		start = high_resolution_clock::now();
+		items = list->sorted.data;
+		scratch.keys.count = render_cull_frustum(items, queue_size, viewprojs, view_count, depth, scratch.keys.data);
+		list->stats.culled_frustum = queue_size - scratch.keys.count;
+		list->stats.ms_cull += render_ms_since(start);
+
+		render_draw_occlusion(list, items, viewprojs, view_count);
+
+		if (depth != nullptr) {
+			start = high_resolution_clock::now();
+			radix_sort_keys(scratch);
+			list->stats.ms_sort += render_ms_since(start);
+		}
+
+		rebuild =
+			list->built_view_count    != view_count ||
+			list->built_visible.count != scratch.keys.count;
+		for (int32_t i = 0; !rebuild && i < scratch.keys.count; i++)
+			rebuild = list->built_visible[i].index != scratch.keys[i].index;
+	} else {
+		// Cull anything that isn't visible from any of the views, and sort
+		// whatever's left. This leaves the queue itself untouched, so it
+		// can be drawn again from other views, like for screenshots.
+		start = high_resolution_clock::now();
+		items = list->queue.data;
+		scratch.keys.count = render_cull_frustum(items, queue_size, viewprojs, view_count, depth, scratch.keys.data);
+		list->stats.culled_frustum = queue_size - scratch.keys.count;
+		list->stats.ms_cull += render_ms_since(start);
+
+		render_draw_occlusion(list, items, viewprojs, view_count);
+
+		start = high_resolution_clock::now();
+		radix_sort_keys(scratch);
+		list->stats.ms_sort += render_ms_since(start);
+	}
+
+	if (rebuild) {
+		start = high_resolution_clock::now();
+		render_build_commands(list, items, scratch.keys.data, scratch.keys.count, view_count);
+		list->stats.ms_instances += render_ms_since(start);
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+void render_draw_occlusion(render_list_t list, const render_item_t *items, const XMMATRIX *viewprojs, int32_t view_count) {
+	list->stats.culled_occlusion = 0;
+	if (list->occluders.count == 0)
+		return;
+	profile_zone("render_occlusion");
+
+	time_point<high_resolution_clock> start = high_resolution_clock::now();
+	render_sort_scratch_t &scratch = list->sort_scratch;
+	render_occlusion_rasterize(list->occluders.data, list->occluders.count, viewprojs, view_count);
+	int32_t visible = render_occlusion_cull(items, scratch.keys.data, scratch.keys.count);
+
+	list->stats.culled_occlusion = scratch.keys.count - visible;
+	list->stats.ms_occlusion += render_ms_since(start);
+	scratch.keys.count = visible;
+}
+
+///////////////////////////////////////////
+
+void render_build_commands(render_list_t list, const render_item_t *items, const render_sort_key_t *order, int32_t count, int32_t view_count) {
+	profile_zone("render_instances");
+	// Batch up the sorted items into a list of commands for the backend.
+	// Instance data for the whole list goes into a single array, and the
+	// commands just reference ranges within it.
+	list->commands .clear();
+	list->instances.clear();
+	render_last_material = nullptr;
+	render_last_shader   = nullptr;
+	render_last_mesh     = nullptr;
 
-	if (render_sky_cubemap != nullptr) {
-		d3d_context->VSSetSamplers       (11, 1, &render_sky_cubemap->sampler);
-		d3d_context->VSSetShaderResources(11, 1, &render_sky_cubemap->resource);
-		d3d_context->PSSetSamplers       (11, 1, &render_sky_cubemap->sampler);
-		d3d_context->PSSetShaderResources(11, 1, &render_sky_cubemap->resource);
+	// Lists only count the commands they currently hold
+	list->stats.swaps_mesh     = 0;
+	list->stats.swaps_shader   = 0;
+	list->stats.swaps_texture  = 0;
+	list->stats.swaps_material = 0;
+	list->stats.draw_calls     = 0;
+	list->stats.draw_instances = 0;
+
+	if (list->retained) {
+		if (list->built_visible.capacity < count)
+			list->built_visible.resize(count);
+		memcpy(list->built_visible.data, order, sizeof(render_sort_key_t) * count);
+		list->built_visible.count = count;
+		list->built_view_count    = view_count;
 	}
+	if (count == 0) return;
 
-	render_item_t *item          = &render_list->queue[0];
-	material_t     last_material = item->material;
-	mesh_t         last_mesh     = item->mesh;
+	const render_item_t *item          = &items[order[0].index];
+	material_t           last_material = item->material;
+	mesh_t               last_mesh     = item->mesh;
+	int32_t              batch_start   = 0;
 	
-	for (size_t i = 0; i < queue_size; i++) {
-		XMMATRIX transpose = XMMatrixTranspose(item->transform);
+	for (int32_t i = 0; i < count; i++) {
+		// Retained lists have already done the transpose
+		render_transform_buffer_t inst = list->retained
+			? list->sorted_transforms[order[i].index]
+			: render_transform_buffer_t { XMMatrixTranspose(item->transform), item->color, 0 };
 		for (int32_t v = 0; v < view_count; v++) {
-			render_instance_list.add(render_transform_buffer_t { transpose, item->color, (uint32_t)v } );
+			inst.view_id = (uint32_t)v;
+			list->instances.add(inst);
 		}
 
-		render_item_t *next = i+1>=queue_size?nullptr:&render_list->queue[i+1];
+		const render_item_t *next = i+1>=count?nullptr:&items[order[i+1].index];
 		if (next == nullptr || last_material != next->material || last_mesh != next->mesh) {
-			render_set_material(item->material);
-			render_set_mesh    (item->mesh);
-
-			size_t offsets = 0, count = 0;
-			do {
-				shaderargs_t *instances = render_fill_inst_buffer(render_instance_list, offsets, count);
-				shaderargs_set_active(*instances, false);
-				render_draw_item((int)count);
-			} while (offsets != 0);
-			render_instance_list.clear();
+			render_emit_material(list, item->material);
+			render_emit_mesh    (list, item->mesh);
+
+			// Split the batch up if it has more instances than the shader
+			// can take in a single draw.
+			while (batch_start < list->instances.count) {
+				int32_t batch_count = mini(list->instances.count - batch_start, render_instance_max);
+				render_emit_draw(list, batch_start, batch_count);
+				batch_start += batch_count;
+			}
 			
 			if (next != nullptr) {
 				last_material = next->material;
@@ -322,14 +707,222 @@ void render_draw_queue(const matrix *views, const matrix *projections, int32_t v
 
 ///////////////////////////////////////////
 
+void render_list_sort_retained(render_list_t list) {
+	profile_zone("render_sort_retained");
+	int32_t                count   = list->queue.count;
+	render_sort_scratch_t &scratch = list->sort_scratch;
+	for (int32_t i = 0; i < count; i++) {
+		scratch.keys[i].sort_id = list->queue[i].sort_id;
+		scratch.keys[i].index   = (uint32_t)i;
+	}
+	scratch.keys.count = count;
+	radix_sort_keys(scratch);
+
+	// Store the items in their sorted order, along with their instance
+	// data, so none of this needs redoing until the list changes.
+	if (list->sorted.capacity < count) {
+		list->sorted           .resize(count);
+		list->sorted_transforms.resize(count);
+	}
+	for (int32_t i = 0; i < count; i++) {
+		const render_item_t &item = list->queue[scratch.keys[i].index];
+		list->sorted           [i] = item;
+		list->sorted_transforms[i] = render_transform_buffer_t { XMMatrixTranspose(item.transform), item.color, 0 };
+	}
+	list->sorted           .count = count;
+	list->sorted_transforms.count = count;
+
+	// And where each queue item ended up, so single items can be updated
+	// in place later on.
+	if (list->sorted_lookup.capacity < count)
+		list->sorted_lookup.resize(count);
+	for (int32_t i = 0; i < count; i++)
+		list->sorted_lookup[scratch.keys[i].index] = i;
+	list->sorted_lookup.count = count;
+
+	list->state            = render_list_state_rendered;
+	list->built_view_count = 0;
+}
+
+///////////////////////////////////////////
+
+void render_emit_material(render_list_t list, material_t material) {
+	if (material == render_last_material)
+		return;
+	render_last_material = material;
+	list->stats.swaps_material++;
+
+	if (material->shader != render_last_shader) {
+		render_last_shader = material->shader;
+		list->stats.swaps_shader++;
+	}
+
+	render_cmd_t cmd;
+	cmd.type     = render_cmd_material;
+	cmd.material = material;
+	list->commands.add(cmd);
+}
+
+///////////////////////////////////////////
+
+void render_emit_mesh(render_list_t list, mesh_t mesh) {
+	if (mesh == render_last_mesh)
+		return;
+	render_last_mesh = mesh;
+	list->stats.swaps_mesh++;
+
+	render_cmd_t cmd;
+	cmd.type = render_cmd_mesh;
+	cmd.mesh = mesh;
+	list->commands.add(cmd);
+}
+
+///////////////////////////////////////////
+
+void render_emit_draw(render_list_t list, int32_t start, int32_t count) {
+	list->stats.draw_calls++;
+	list->stats.draw_instances += count;
+
+	render_cmd_t cmd;
+	cmd.type            = render_cmd_instances;
+	cmd.instances.start = start;
+	cmd.instances.count = count;
+	list->commands.add(cmd);
+
+	cmd.type       = render_cmd_draw;
+	cmd.draw_count = count;
+	list->commands.add(cmd);
+}
+
+///////////////////////////////////////////
+
 void render_draw_matrix(const matrix* views, const matrix* projections, int32_t count) {
-	render_draw_queue(views, projections, count);
-	render_check_screenshots();
+	render_submit_merge(render_list_primary);
+
+	// Drawing a frame late only works when nothing else depends on the
+	// views, and XR runtimes pair each frame's views with its poses.
+	if (render_pipelined && sk_active_runtime() == runtime_mixedreality) {
+		log_warn("render_set_pipelined: Pipelined rendering isn't available for mixed reality, turning it off.");
+		render_pipelined = false;
+	}
+
+	if (!render_pipelined) {
+		render_pipeline_finish();
+		render_pipeline_stop();
+		render_draw_queue(render_instance_list, views, projections, count);
+		render_draw_queue(render_list_primary,  views, projections, count);
+		render_check_screenshots(render_list_primary);
+		return;
+	}
+
+	if (!render_pipeline.running) {
+		render_pipeline.list           = render_list_create();
+		render_pipeline.list->retained = false;
+		render_pipeline.running        = true;
+		render_pipeline.thread         = std::thread(render_pipeline_thread);
+	}
+
+	// Draw last frame's list, which the render thread should have ready
+	// by now. This also frees it up for this frame.
+	render_pipeline_finish();
+
+	render_list_t frame  = render_list_primary;
+	render_list_primary  = render_pipeline.list;
+	render_pipeline.list = frame;
+	render_list_stack[0] = render_list_primary;
+	render_list_primary->sort = render_frame_sort;
+
+	render_pipeline.view_count = mini(count, 2);
+	memcpy(render_pipeline.views, views,       sizeof(matrix) * render_pipeline.view_count);
+	memcpy(render_pipeline.projs, projections, sizeof(matrix) * render_pipeline.view_count);
+	render_fill_globals(render_pipeline.globals);
+
+	render_pipeline.lock.lock();
+	render_pipeline.job_ready = true;
+	render_pipeline.in_flight = true;
+	render_pipeline.lock.unlock();
+	render_pipeline.signal.notify_all();
 }
 
 ///////////////////////////////////////////
 
-void render_check_screenshots() {
+void render_pipeline_thread() {
+	profiler_thread_name("Render");
+	std::unique_lock<std::mutex> lock(render_pipeline.lock);
+	while (true) {
+		render_pipeline.signal.wait(lock, []{ return render_pipeline.job_ready || !render_pipeline.running; });
+		if (!render_pipeline.job_ready)
+			break;
+
+		lock.unlock();
+		bool prepared = render_prepare_queue(render_pipeline.list, render_pipeline.views, render_pipeline.projs, render_pipeline.view_count, render_pipeline.globals);
+		lock.lock();
+
+		render_pipeline.prepared  = prepared;
+		render_pipeline.job_ready = false;
+		render_pipeline.signal.notify_all();
+	}
+
+	// Culling keeps its scratch memory per thread
+	render_cull_shutdown();
+	render_occlusion_shutdown();
+}
+
+///////////////////////////////////////////
+
+void render_pipeline_finish() {
+	if (!render_pipeline.in_flight)
+		return;
+
+	std::unique_lock<std::mutex> lock(render_pipeline.lock);
+	render_pipeline.signal.wait(lock, []{ return !render_pipeline.job_ready; });
+	lock.unlock();
+
+	// Persistent instances draw with the same views as the list they go
+	// with, so they stay in step with the rest of the frame.
+	render_list_t list = render_pipeline.list;
+	render_draw_queue(render_instance_list, render_pipeline.views, render_pipeline.projs, render_pipeline.view_count);
+	if (render_pipeline.prepared)
+		render_submit_queue(list, render_pipeline.globals);
+	render_check_screenshots(list);
+
+	render_frame_stats        = list->stats;
+	render_pipeline.in_flight = false;
+}
+
+///////////////////////////////////////////
+
+void render_pipeline_stop() {
+	if (!render_pipeline.running)
+		return;
+
+	// Anything still in flight gets dropped, the render thread finishes
+	// with it before it exits.
+	render_pipeline.lock.lock();
+	render_pipeline.running = false;
+	render_pipeline.lock.unlock();
+	render_pipeline.signal.notify_all();
+	render_pipeline.thread.join();
+	render_pipeline.in_flight = false;
+
+	render_list_free(render_pipeline.list);
+	render_pipeline.list = nullptr;
+}
+
+///////////////////////////////////////////
+
+void render_check_screenshots(render_list_t list) {
+	if (render_screenshot_list.count > 0 && render_backend->type == render_backend_null) {
+		log_warn("render_screenshot: Screenshots aren't available with the null render backend, skipping.");
+		for (size_t i = 0; i < render_screenshot_list.count; i++)
+			free(render_screenshot_list[i].filename);
+		render_screenshot_list.clear();
+		return;
+	}
+
+	// Screenshots shouldn't show up in the stats for the frame itself
+	render_stats_t list_stats     = list->stats;
+	render_stats_t instance_stats = render_instance_list->stats;
 	for (size_t i = 0; i < render_screenshot_list.count; i++) {
 		int32_t  w = render_screenshot_list[i].width;
 		int32_t  h = render_screenshot_list[i].height;
@@ -355,14 +948,12 @@ void render_check_screenshots() {
 		tex_add_zbuffer(render_capture_surface);
 
 		// Setup to render the screenshot
-		D3D11_VIEWPORT viewport = CD3D11_VIEWPORT(0.f, 0.f, (float)w, (float)h);
-		d3d_context->RSSetViewports(1, &viewport);
-		tex_rtarget_clear(render_capture_surface, render_clear_color);
-		tex_rtarget_set_active(render_capture_surface);
+		render_backend->target_begin(render_capture_surface, w, h, render_clear_color);
 		
 		// Render!
-		render_draw_queue(&view, &proj, 1);
-		tex_rtarget_set_active(nullptr);
+		render_draw_queue(render_instance_list, &view, &proj, 1);
+		render_draw_queue(list,                 &view, &proj, 1);
+		render_backend->target_end();
 
 		// And save the screenshot to file
 		tex_get_data(render_capture_surface, buffer, size);
@@ -371,29 +962,32 @@ void render_check_screenshots() {
 		free(render_screenshot_list[i].filename);
 	}
 	render_screenshot_list.clear();
+	list->stats                 = list_stats;
+	render_instance_list->stats = instance_stats;
 }
 
 ///////////////////////////////////////////
 
 void render_clear() {
-	//log_infof("draws: %d, instances: %d, material: %d, shader: %d, texture %d, mesh %d", render_stats.draw_calls, render_stats.draw_instances, render_stats.swaps_material, render_stats.swaps_shader, render_stats.swaps_texture, render_stats.swaps_mesh);
-	render_list_stack.last()->queue.clear();
-	render_list_stack.last()->stats = {};
-
-	render_last_material = nullptr;
-	render_last_shader   = nullptr;
-	render_last_mesh     = nullptr;
+	// Pipelined frames are still in flight here, so their stats come in
+	// once they're drawn.
+	if (!render_pipeline.in_flight)
+		render_frame_stats = render_list_primary->stats;
+	render_list_clear(render_list_primary);
+	render_frame_id += 1;
 }
 
 ///////////////////////////////////////////
 
 bool render_initialize() {
-	shaderargs_create(render_shader_globals, sizeof(render_global_buffer_t), 0);
-	shaderargs_create(render_shader_blit,    sizeof(render_blit_data_t),     1);
+	render_is_main_thread     = true;
+	render_submit_generation += 1;
 
-	for (size_t i = 0; i < _countof(render_instance_buffers); i++) {
-		shaderargs_create(render_instance_buffers[i].buffer, sizeof(render_transform_buffer_t) * render_instance_buffers[i].max, 1);
+	if (!render_backend->init()) {
+		log_err("Render backend failed to initialize!");
+		return false;
 	}
+	render_backend_initialized = true;
 
 	// Setup a default camera
 	render_set_clip(render_clip_planes.x, render_clip_planes.y);
@@ -407,6 +1001,10 @@ bool render_initialize() {
 	shader_set_id(sky_shader, "render/skybox_shader");
 	render_sky_mesh = mesh_gen_sphere(1, 3);
 	mesh_set_id(render_sky_mesh, "render/skybox_mesh");
+	// The sky is drawn at the far plane no matter where the sphere is, so
+	// zero out its bounds to keep it from ever getting frustum culled.
+	bounds_t sky_bounds = {};
+	mesh_set_bounds(render_sky_mesh, sky_bounds);
 	render_sky_mat  = material_create(sky_shader);
 	material_set_id          (render_sky_mat, "render/skybox_material");
 	material_set_queue_offset(render_sky_mat, 100);
@@ -414,7 +1012,15 @@ bool render_initialize() {
 	shader_release(sky_shader);
 
 	render_default_tex = tex_find(default_id_tex);
-	render_list_stack.add(render_list_create());
+	render_list_primary = render_list_create();
+	render_list_primary->retained = false;
+	render_list_primary->sort     = render_frame_sort;
+	render_list_stack.add(render_list_primary);
+
+	// Persistent instances keep their material sorted order, so they only
+	// need re-sorting when instances are created or destroyed.
+	render_instance_list = render_list_create();
+	render_instance_list->sort = render_sort_material;
 
 	return true;
 }
@@ -424,6 +1030,8 @@ bool render_initialize() {
 void render_update() {
 	if (hierarchy_stack.count > 0)
 		log_err("Render transform stack doesn't have matching begin/end calls!");
+	if (render_list_stack.count > 1)
+		log_err("Render list stack doesn't have matching push/pop calls!");
 
 	if (render_sky_show && sk_system_info().display_type == display_opaque) {
 		render_add_mesh(render_sky_mesh, render_sky_mat, matrix_identity);
@@ -433,59 +1041,52 @@ void render_update() {
 ///////////////////////////////////////////
 
 void render_shutdown() {
+	render_pipeline_stop();
+	for (int32_t i = 0; render_instance_list != nullptr && i < render_instance_list->queue.count; i++) {
+		mesh_release    (render_instance_list->queue[i].mesh);
+		material_release(render_instance_list->queue[i].material);
+	}
+	for (int32_t i = 0; i < render_instances.count; i++) {
+		model_release   (render_instances[i]->model);
+		mesh_release    (render_instances[i]->mesh);
+		material_release(render_instances[i]->material);
+		sk_free(render_instances[i]->offsets);
+		sk_free(render_instances[i]);
+	}
+	render_instances.free();
+	render_instance_list = nullptr;
 	for (int32_t i = 0; i < render_lists.count; i++) {
-		render_lists[i]->queue.free();
+		render_list_free_data(render_lists[i]);
+		sk_free(render_lists[i]);
 	}
+	render_lists     .free();
 	render_list_stack.free();
+	render_list_primary = nullptr;
 	render_screenshot_list.free();
-	render_instance_list.free();
+	render_cull_shutdown();
+	render_occlusion_shutdown();
+	for (int32_t i = 0; i < render_submit_buffers.count; i++) {
+		render_submit_buffers[i]->items    .free();
+		render_submit_buffers[i]->occluders.free();
+		delete render_submit_buffers[i];
+	}
+	render_submit_buffers.free();
 
 	material_release(render_sky_mat);
 	mesh_release    (render_sky_mesh);
 	tex_release   (render_sky_cubemap);
 	tex_release   (render_default_tex);
 
-	for (size_t i = 0; i < _countof(render_instance_buffers); i++) {
-		shaderargs_destroy(render_instance_buffers[i].buffer);
-	}
-
-	shaderargs_destroy(render_shader_blit);
-	shaderargs_destroy(render_shader_globals);
 	mesh_release(render_blit_quad);
+
+	render_backend->shutdown();
+	render_backend_initialized = false;
 }
 
 ///////////////////////////////////////////
 
 void render_blit(tex_t to, material_t material) {
-	// Set up where on the render target we want to draw, the view has a 
-	D3D11_VIEWPORT viewport = CD3D11_VIEWPORT(0.f, 0.f, (float)to->width, (float)to->height);
-	d3d_context->RSSetViewports(1, &viewport);
-
-	// Wipe our swapchain color and depth target clean, and then set them up for rendering!
-	tex_rtarget_clear(to, { 0,0,0,0 });
-	tex_rtarget_set_active(to);
-
-	// Setup shader args for the blit operation
-	render_blit_data_t data = {};
-	data.width  = (float)to->width;
-	data.height = (float)to->height;
-	data.pixel_width  = 1.0f / to->width;
-	data.pixel_height = 1.0f / to->height;
-
-	// Setup render states for blitting
-	shaderargs_set_data  (render_shader_blit, &data);
-	shaderargs_set_active(render_shader_blit);
-	render_set_material(material);
-	render_set_mesh    (render_blit_quad);
-	
-	// And draw to it!
-	render_draw_item(1);
-
-	tex_rtarget_set_active(nullptr);
-
-	render_last_material = nullptr;
-	render_last_mesh = nullptr;
-	render_last_shader = nullptr;
+	render_backend->blit(to, material, render_blit_quad);
 }
 
 ///////////////////////////////////////////
@@ -497,167 +1098,311 @@ void render_screenshot(vec3 from_viewpt, vec3 at, int width, int height, const c
 
 ///////////////////////////////////////////
 
-void render_set_material(material_t material) {
-	if (material == render_last_material)
-		return;
-	render_last_material = material;
-	render_list_stack.last()->stats.swaps_material++;
+vec3 render_unproject_pt(vec3 normalized_screen_pt) {
+	matrix mat;
+	matrix_mul(render_camera_root_inv, render_default_camera_proj, mat);
+	matrix_inverse(mat, mat);
+	return matrix_mul_point(mat, normalized_screen_pt);
+}
 
-	render_set_shader    (material->shader);
-	shaderargs_set_data  (material->shader->args, material->args.buffer);
-	shaderargs_set_active(material->shader->args);
+///////////////////////////////////////////
 
-	// Fill an array of texture data so we can set them all at the same time
-	ID3D11SamplerState       *samplers [10];
-	ID3D11ShaderResourceView *resources[10];
-	assert(material->shader->tex_slots.tex_count < 10);
+void render_get_device(void **device, void **context) {
+	*device  = d3d_device;
+	*context = d3d_context;
+}
 
-	// Use a texture from the material, or use the default! But don't
-	// leave any empty, or we can get overflow from previous renders.
-	for (int i = 0; i < material->shader->tex_slots.tex_count; i++) {
-		tex_t tex = material->args.textures[i];
-		if (tex == nullptr)
-			tex = material->shader->tex_slots.tex[i].default_tex;
+///////////////////////////////////////////
 
-		samplers [i] = tex->sampler;
-		resources[i] = tex->resource;
+void render_set_backend(render_backend_ backend) {
+	if (render_backend_initialized) {
+		log_err("render_set_backend: The render backend can only be changed before the renderer initializes!");
+		return;
 	}
-	if (material->shader->tex_slots.tex_count != 0) {
-		d3d_context->PSSetSamplers       (0, material->shader->tex_slots.tex_count, samplers);
-		d3d_context->PSSetShaderResources(0, material->shader->tex_slots.tex_count, resources);
-		d3d_context->VSSetSamplers       (0, material->shader->tex_slots.tex_count, samplers);
-		d3d_context->VSSetShaderResources(0, material->shader->tex_slots.tex_count, resources);
+	for (size_t i = 0; i < _countof(render_backends); i++) {
+		if (render_backends[i].type == backend) {
+			render_backend = &render_backends[i];
+			return;
+		}
 	}
+}
 
-	if (material->alpha_mode == transparency_none) {
-		d3d_context->OMSetBlendState(0,0, 0xFFFFFFFF);
-	} else {
-		d3d_context->OMSetBlendState(material->blend_state, nullptr, 0xFFFFFFFF);
+///////////////////////////////////////////
+
+render_backend_ render_get_backend() {
+	return render_backend->type;
+}
+
+///////////////////////////////////////////
+
+render_list_t render_list_create() {
+	memory_scope(memory_tag_render);
+	render_list_t result = (render_list_t)sk_malloc(sizeof(_render_list_t));
+	*result = {};
+	result->retained = true;
+	result->sort     = render_sort_depth;
+	render_lists.add(result);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void render_list_free_data(render_list_t list) {
+	list->queue                .free();
+	list->occluders            .free();
+	list->sort_scratch.keys.free();
+	list->commands             .free();
+	list->instances            .free();
+	list->sorted               .free();
+	list->sorted_transforms    .free();
+	list->sorted_lookup        .free();
+	list->built_visible        .free();
+}
+
+///////////////////////////////////////////
+
+void render_list_free(render_list_t list) {
+	if (list == nullptr)
+		return;
+	for (int32_t i = 0; i < render_list_stack.count; i++) {
+		if (render_list_stack[i] == list) {
+			log_err("render_list_free: Can't free a render list while it's pushed!");
+			return;
+		}
 	}
-	if (material->rasterizer_state != nullptr) {
-		d3d_context->RSSetState(material->rasterizer_state);
-	} else {
-		d3d_context->RSSetState(d3d_rasterstate);
+
+	for (int32_t i = 0; i < render_lists.count; i++) {
+		if (render_lists[i] == list) {
+			render_lists.remove(i);
+			break;
+		}
 	}
+	render_list_free_data(list);
+	sk_free(list);
 }
 
 ///////////////////////////////////////////
 
-void render_set_shader(shader_t shader) {
-	if (shader == render_last_shader)
-		return;
-	render_last_shader = shader;
-	render_list_stack.last()->stats.swaps_shader++;
+void render_list_push(render_list_t list) {
+	render_list_stack.add(list);
+}
 
-	d3d_context->VSSetShader(shader->vshader, nullptr, 0);
-	d3d_context->PSSetShader(shader->pshader, nullptr, 0);
-	d3d_context->IASetInputLayout(shader->vert_layout);
+///////////////////////////////////////////
+
+void render_list_pop() {
+	if (render_list_stack.count <= 1) {
+		log_err("render_list_pop: Called without a matching render_list_push!");
+		return;
+	}
+	render_list_stack.pop();
 }
 
 ///////////////////////////////////////////
 
-void render_set_mesh(mesh_t mesh) {
-	if (mesh == render_last_mesh)
+void render_list_execute(render_list_t list, tex_t to_rendertarget, const matrix *views, const matrix *projections, int32_t view_count) {
+	if (list == nullptr) {
+		log_err("render_list_execute: list can't be null!");
 		return;
-	render_last_mesh = mesh;
-	render_list_stack.last()->stats.swaps_mesh++;
+	}
+	if (view_count < 1 || view_count > 2) {
+		log_errf("render_list_execute: view_count must be 1 or 2, got %d!", view_count);
+		return;
+	}
 
-	UINT strides[] = { sizeof(vert_t) };
-	UINT offsets[] = { 0 };
-	d3d_context->IASetVertexBuffers(0, 1, &mesh->vert_buffer, strides, offsets);
-#ifdef SK_32BIT_INDICES
-	d3d_context->IASetIndexBuffer  (mesh->ind_buffer, DXGI_FORMAT_R32_UINT, 0);
-#else
-	d3d_context->IASetIndexBuffer  (mesh->ind_buffer, DXGI_FORMAT_R16_UINT, 0);
-#endif
+	if (to_rendertarget != nullptr)
+		render_backend->target_begin(to_rendertarget, to_rendertarget->width, to_rendertarget->height, render_clear_color);
+	render_draw_queue(list, views, projections, view_count);
+	if (to_rendertarget != nullptr)
+		render_backend->target_end();
 }
 
 ///////////////////////////////////////////
 
-void render_draw_item(int count) {
-	render_list_t list = render_list_stack.last();
-	list->stats.draw_calls++;
-	list->stats.draw_instances += count;
+void render_list_clear(render_list_t list) {
+	list->queue    .clear();
+	list->occluders.clear();
+	list->stats = {};
+	list->state = render_list_state_empty;
+}
 
-	d3d_context->DrawIndexedInstanced(render_last_mesh->ind_draw, count, 0, 0, 0);
+///////////////////////////////////////////
+
+void render_list_set_sort(render_list_t list, render_sort_ sort) {
+	list->sort = sort;
 }
 
 ///////////////////////////////////////////
 
-shaderargs_t *render_fill_inst_buffer(array_t<render_transform_buffer_t> &list, size_t &offset, size_t &out_count) {
-	// Find a buffer that can contain this list! Or the biggest one
-	size_t size  = list.count - offset;
-	size_t index = 0;
-	for (size_t i = 0; i < _countof(render_instance_buffers); i++) {
-		index = i;
-		if (render_instance_buffers[i].max >= size)
-			break;
-	}
-	size_t start = offset;
+render_stats_t render_list_get_stats(render_list_t list) {
+	// The frame's list gets cleared each frame, so it reports the last
+	// complete frame. Retained lists report their last execute.
+	return list->retained
+		? list->stats
+		: render_frame_stats;
+}
 
-	// Check if it fits, if it doesn't, then set up data so we only fill what we have!
-	if (size > render_instance_buffers[index].max) {
-		offset   += render_instance_buffers[index].max;
-		out_count = render_instance_buffers[index].max;
-	} else {
-		// this means we've gotten through the whole list :)
-		offset    = 0;
-		out_count = size;
-	}
+///////////////////////////////////////////
 
-	// Copy data into the buffer, and return it!
-	shaderargs_set_data(render_instance_buffers[index].buffer, &list[start], sizeof(render_transform_buffer_t) * out_count);
-	return &render_instance_buffers[index].buffer;
+render_stats_t render_get_stats() {
+	return render_frame_stats;
 }
 
 ///////////////////////////////////////////
 
-vec3 render_unproject_pt(vec3 normalized_screen_pt) {
-	matrix mat;
-	matrix_mul(render_camera_root_inv, render_default_camera_proj, mat);
-	matrix_inverse(mat, mat);
-	return matrix_mul_point(mat, normalized_screen_pt);
+void render_set_pipelined(bool32_t pipelined) {
+	render_pipelined = pipelined;
 }
 
 ///////////////////////////////////////////
 
-void render_get_device(void **device, void **context) {
-	*device  = d3d_device;
-	*context = d3d_context;
+bool32_t render_get_pipelined() {
+	return render_pipelined;
 }
 
 ///////////////////////////////////////////
 
-render_list_t render_list_create() {
-	render_list_t result = (render_list_t)malloc(sizeof(_render_list_t));
-	*result = {};
-	render_lists.add(result);
-	return result;
+void render_set_sort(render_sort_ sort) {
+	// Pipelined frames trade lists with the render thread, so the list
+	// that comes back picks this up when it does.
+	render_frame_sort         = sort;
+	render_list_primary->sort = sort;
 }
 
 ///////////////////////////////////////////
 
-void render_list_free(render_list_t list) {
+render_sort_ render_get_sort() {
+	return render_frame_sort;
 }
 
 ///////////////////////////////////////////
 
-void render_list_push(render_list_t list) {
+render_instance_t render_instance_add(model_t model, mesh_t mesh, material_t material, const matrix &transform, color128 color) {
+	memory_scope(memory_tag_render);
+	render_instance_t result = (render_instance_t)sk_malloc(sizeof(_render_instance_t));
+	*result = {};
+	result->model      = model;
+	result->mesh       = mesh;
+	result->material   = material;
+	result->item_start = render_instance_list->queue.count;
+	result->item_count = model != nullptr ? model->subset_count : 1;
+	result->offsets    = (XMMATRIX*)sk_malloc(sizeof(XMMATRIX) * result->item_count);
+	if (model    != nullptr) assets_addref(model   ->header);
+	if (mesh     != nullptr) assets_addref(mesh    ->header);
+	if (material != nullptr) assets_addref(material->header);
+
+	XMMATRIX root;
+	if (hierarchy_enabled) {
+		matrix_mul(transform, hierarchy_stack.last().transform, root);
+	} else {
+		math_matrix_to_fast(transform, &root);
+	}
+
+	for (int32_t i = 0; i < result->item_count; i++) {
+		render_item_t item;
+		item.mesh     = model != nullptr ? model->subsets[i].mesh     : mesh;
+		item.material = model != nullptr ? model->subsets[i].material : material;
+		item.color    = color;
+		item.sort_id  = render_queue_id(item.material, item.mesh);
+		// Items hold their own references, since the model can swap or
+		// release its subsets' assets while this instance is still around.
+		assets_addref(item.mesh    ->header);
+		assets_addref(item.material->header);
+		if (model != nullptr) math_matrix_to_fast(model->subsets[i].offset, &result->offsets[i]);
+		else                  result->offsets[i] = XMMatrixIdentity();
+		item.transform = result->offsets[i] * root;
+		render_instance_list->queue.add(item);
+	}
+	render_instance_list->state = render_list_state_used;
+	render_instances.add(result);
+	return result;
 }
 
 ///////////////////////////////////////////
 
-void render_list_pop() {
+render_instance_t render_instance_create(model_t model, const matrix &transform, color128 color) {
+	if (model == nullptr) {
+		log_err("render_instance_create: model can't be null!");
+		return nullptr;
+	}
+	return render_instance_add(model, nullptr, nullptr, transform, color);
 }
 
 ///////////////////////////////////////////
 
-void render_list_execute(render_list_t list, const matrix *views, const matrix *projs, int32_t view_count) {
+render_instance_t render_instance_create_mesh(mesh_t mesh, material_t material, const matrix &transform, color128 color) {
+	if (mesh == nullptr || material == nullptr) {
+		log_err("render_instance_create_mesh: mesh and material can't be null!");
+		return nullptr;
+	}
+	return render_instance_add(nullptr, mesh, material, transform, color);
 }
 
 ///////////////////////////////////////////
 
-void render_list_clear(render_list_t list) {
+void render_instance_set_transform(render_instance_t instance, const matrix &transform) {
+	if (instance == nullptr)
+		return;
+
+	XMMATRIX root;
+	if (hierarchy_enabled) {
+		matrix_mul(transform, hierarchy_stack.last().transform, root);
+	} else {
+		math_matrix_to_fast(transform, &root);
+	}
+
+	// Moving doesn't change the sort order, so if the list is already
+	// sorted, we can patch the sorted copy and its instance data in place.
+	// Commands still need rebuilding, but that's just copying.
+	render_list_t list   = render_instance_list;
+	bool          sorted = list->state == render_list_state_rendered;
+	for (int32_t i = 0; i < instance->item_count; i++) {
+		int32_t        index = instance->item_start + i;
+		render_item_t &item  = list->queue[index];
+		item.transform = instance->offsets[i] * root;
+
+		if (sorted) {
+			int32_t at = list->sorted_lookup[index];
+			list->sorted           [at].transform = item.transform;
+			list->sorted_transforms[at].world     = XMMatrixTranspose(item.transform);
+		}
+	}
+	list->built_view_count = 0;
+}
+
+///////////////////////////////////////////
+
+void render_instance_destroy(render_instance_t instance) {
+	if (instance == nullptr)
+		return;
+
+	// Pull this instance's items out of the queue, and shift everything
+	// after it down to match.
+	render_list_t list = render_instance_list;
+	int32_t       end  = instance->item_start + instance->item_count;
+	for (int32_t i = instance->item_start; i < end; i++) {
+		mesh_release    (list->queue[i].mesh);
+		material_release(list->queue[i].material);
+	}
+	memmove(
+		&list->queue[instance->item_start],
+		&list->queue[end],
+		sizeof(render_item_t) * (list->queue.count - end));
+	list->queue.count -= instance->item_count;
+	list->state        = render_list_state_used;
+
+	for (int32_t i = render_instances.count - 1; i >= 0; i--) {
+		if (render_instances[i] == instance) {
+			render_instances.remove(i);
+		} else if (render_instances[i]->item_start > instance->item_start) {
+			render_instances[i]->item_start -= instance->item_count;
+		}
+	}
+
+	model_release   (instance->model);
+	mesh_release    (instance->mesh);
+	material_release(instance->material);
+	sk_free(instance->offsets);
+	sk_free(instance);
 }
 
-} // namespace sk
\ No newline at end of file
+} // namespace sk
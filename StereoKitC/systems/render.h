@@ -6,13 +6,20 @@
 
 namespace sk {
 
-struct render_stats_t {
-	int swaps_mesh;
-	int swaps_shader;
-	int swaps_texture;
-	int swaps_material;
-	int draw_calls;
-	int draw_instances;
+struct render_transform_buffer_t {
+	DirectX::XMMATRIX world;
+	color128          color;
+	uint32_t          view_id;
+};
+struct render_global_buffer_t {
+	DirectX::XMMATRIX view[2];
+	DirectX::XMMATRIX proj[2];
+	DirectX::XMMATRIX viewproj[2];
+	vec4              lighting[9];
+	vec4              camera_pos[2];
+	vec4              camera_dir[2];
+	vec4              fingertip[2];
+	float             time;
 };
 
 struct render_item_t {
@@ -23,6 +30,74 @@ struct render_item_t {
 	uint64_t    sort_id;
 };
 
+struct render_occluder_t {
+	DirectX::XMMATRIX transform;
+	mesh_t            mesh;
+};
+
+// Compact sort key used by the renderer's radix sort, the render_item_t is
+// big enough that moving it around on every pass gets expensive.
+struct render_sort_key_t {
+	uint64_t sort_id;
+	uint32_t index;
+};
+
+// Persistent memory for sorting, so the queue doesn't need to allocate
+// anything while sorting each frame.
+struct render_sort_scratch_t {
+	array_t<render_sort_key_t> keys;
+};
+
+///////////////////////////////////////////
+
+// The renderer's frontend sorts and batches the queue into a compact list
+// of commands, and the backend turns those into actual API calls. This
+// keeps all the sorting/batching/instancing logic free of graphics API
+// code, so it can also run without a GPU.
+enum render_cmd_ {
+	render_cmd_material = 0,
+	render_cmd_mesh,
+	render_cmd_instances,
+	render_cmd_draw,
+};
+
+struct render_cmd_t {
+	render_cmd_ type;
+	union {
+		material_t material;
+		mesh_t     mesh;
+		struct {
+			int32_t start;
+			int32_t count;
+		} instances;
+		int32_t draw_count;
+	};
+};
+
+enum render_backend_ {
+	render_backend_d3d11 = 0,
+	render_backend_null,
+};
+
+struct render_backend_t {
+	render_backend_ type;
+	bool (*init)        ();
+	void (*shutdown)    ();
+	void (*begin_queue) (const render_global_buffer_t &globals, tex_t sky_cubemap);
+	void (*execute)     (const render_cmd_t *commands, int32_t command_count, const render_transform_buffer_t *instances, int32_t instance_count);
+	void (*blit)        (tex_t to, material_t material, mesh_t quad);
+	void (*target_begin)(tex_t target, int32_t width, int32_t height, color32 clear_color);
+	void (*target_end)  ();
+};
+
+// The shader side TransformBuffer has room for this many instances, so
+// that's the most we can draw with a single call.
+const int32_t render_instance_max = 682;
+
+// Size of render_stats_t::lod_counts, the last entry also counts anything
+// past it.
+const int32_t render_lod_stat_levels = 8;
+
 enum render_list_state_ {
 	render_list_state_empty = 0,
 	render_list_state_used,
@@ -30,12 +105,27 @@ enum render_list_state_ {
 };
 
 struct _render_list_t {
-	array_t<render_item_t> queue;
-	render_stats_t         stats;
-	render_list_state_     state;
+	array_t<render_item_t>             queue;
+	array_t<render_occluder_t>         occluders;
+	render_sort_scratch_t              sort_scratch;
+	render_stats_t                     stats;
+	render_list_state_                 state;
+	render_sort_                       sort;
+
+	// Commands and instance data built from the queue the last time it was
+	// drawn. Retained lists keep these around, and only rebuild them when
+	// the queue or the set of visible items changes.
+	array_t<render_cmd_t>              commands;
+	array_t<render_transform_buffer_t> instances;
+	bool32_t                           retained;
+	array_t<render_item_t>             sorted;
+	array_t<render_transform_buffer_t> sorted_transforms;
+	array_t<int32_t>                   sorted_lookup;
+	array_t<render_sort_key_t>         built_visible;
+	int32_t                            built_view_count;
 };
 
-typedef _render_list_t* render_list_t;
+///////////////////////////////////////////
 
 matrix render_get_projection();
 color32 render_get_clear_color();
@@ -49,16 +139,7 @@ bool render_initialize();
 void render_update();
 void render_shutdown();
 
-void render_set_material(material_t material);
-void render_set_shader  (shader_t   shader);
-void render_set_mesh    (mesh_t     mesh);
-void render_draw_item   (int count);
-
-render_list_t render_list_create ();
-void          render_list_free   (render_list_t list);
-void          render_list_push   (render_list_t list);
-void          render_list_pop    ();
-void          render_list_execute(render_list_t list, const matrix *views, const matrix *projs, int32_t view_count);
-void          render_list_clear  (render_list_t list);
+void            render_set_backend(render_backend_ backend);
+render_backend_ render_get_backend();
 
 } // namespace sk
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "render_cull.h"
+#include "profiler.h"
+#include "../asset_types/mesh.h"
+#include "../asset_types/material.h"
+
+#include <directxmath.h>
+using namespace DirectX;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// World space bounds of 4 items at a time, stored as SoA so we can test
+// all 4 against a plane with just a few vector instructions.
+struct render_cull_group_t {
+	XMFLOAT4 center_x, center_y, center_z;
+	XMFLOAT4 extent_x, extent_y, extent_z;
+};
+
+// Per thread, so the render thread can cull while the main thread does too
+thread_local array_t<render_cull_group_t> render_cull_groups = {};
+
+///////////////////////////////////////////
+
+// Re-packs the material sort key from render_queue_id with a view depth
+// component. Opaque items get a coarse front-to-back bucket above the
+// material, so they still batch well while getting some early-z benefit.
+// Blended items are sorted strictly back-to-front, so the material and
+// mesh only break ties.
+inline uint64_t render_cull_depth_key(const render_item_t &item, float depth01) {
+	uint64_t queue    = (item.sort_id >> 32) & 0xFFFFFF;
+	uint64_t material = (item.sort_id >> 16) & 0xFFFF;
+	uint64_t mesh     =  item.sort_id        & 0xFFFF;
+	if (item.material->alpha_mode == transparency_blend) {
+		uint64_t far_first = (uint64_t)((1 - depth01) * 0xFFFFFF);
+		return (queue << 40) | (far_first << 16) | material;
+	} else {
+		uint64_t near_first = (uint64_t)(sqrtf(depth01) * 0xF);
+		return (queue << 40) | (near_first << 32) | (material << 16) | mesh;
+	}
+}
+
+///////////////////////////////////////////
+
+int32_t render_cull_frustum(const render_item_t *items, int32_t count, const XMMATRIX *viewprojs, int32_t view_count, const render_cull_depth_t *depth, render_sort_key_t *out_keys) {
+	profile_zone("render_cull");
+	// Extract the frustum planes from each view's viewproj matrix. These
+	// don't need normalizing, since we only care about the sign of the
+	// distance, and the box radius gets scaled the same way.
+	XMVECTOR planes[2][6];
+	for (int32_t v = 0; v < view_count; v++) {
+		XMMATRIX cols = XMMatrixTranspose(viewprojs[v]);
+		planes[v][0] = XMVectorAdd     (cols.r[3], cols.r[0]); // Left
+		planes[v][1] = XMVectorSubtract(cols.r[3], cols.r[0]); // Right
+		planes[v][2] = XMVectorAdd     (cols.r[3], cols.r[1]); // Bottom
+		planes[v][3] = XMVectorSubtract(cols.r[3], cols.r[1]); // Top
+		planes[v][4] = cols.r[2];                              // Near
+		planes[v][5] = XMVectorSubtract(cols.r[3], cols.r[2]); // Far
+	}
+
+	// Transform each item's bounds into a world space box
+	int32_t group_count = (count + 3) / 4;
+	if (render_cull_groups.capacity < group_count)
+		render_cull_groups.resize(group_count);
+	render_cull_groups.count = group_count;
+
+	for (int32_t i = 0; i < group_count * 4; i++) {
+		XMFLOAT3 center = {};
+		XMFLOAT3 extent = { 1e30f, 1e30f, 1e30f };
+
+		// Meshes without bounds have all-zero dimensions, and the padding
+		// past the end of the list has no mesh at all. Both of these get a
+		// huge box, so they're never culled. Unbounded meshes still use
+		// their origin as a center, for depth sorting.
+		const bounds_t *bounds = i < count ? &items[i].mesh->bounds : nullptr;
+		if (bounds != nullptr && bounds->dimensions.x == 0 && bounds->dimensions.y == 0 && bounds->dimensions.z == 0) {
+			XMStoreFloat3(&center, items[i].transform.r[3]);
+		} else if (bounds != nullptr) {
+			const XMMATRIX &tr = items[i].transform;
+			XMVECTOR half  = XMVectorScale(XMLoadFloat3((XMFLOAT3*)&bounds->dimensions), 0.5f);
+			XMVECTOR ext_w = XMVectorMultiply(XMVectorAbs(tr.r[0]), XMVectorSplatX(half));
+			ext_w = XMVectorMultiplyAdd(XMVectorAbs(tr.r[1]), XMVectorSplatY(half), ext_w);
+			ext_w = XMVectorMultiplyAdd(XMVectorAbs(tr.r[2]), XMVectorSplatZ(half), ext_w);
+			XMStoreFloat3(&center, XMVector3Transform(XMLoadFloat3((XMFLOAT3*)&bounds->center), tr));
+			XMStoreFloat3(&extent, ext_w);
+		}
+
+		render_cull_group_t &group = render_cull_groups[i / 4];
+		int32_t lane = i % 4;
+		(&group.center_x.x)[lane] = center.x;
+		(&group.center_y.x)[lane] = center.y;
+		(&group.center_z.x)[lane] = center.z;
+		(&group.extent_x.x)[lane] = extent.x;
+		(&group.extent_y.x)[lane] = extent.y;
+		(&group.extent_z.x)[lane] = extent.z;
+	}
+
+	// Test 4 boxes per iteration against every plane of every view. A box
+	// is outside a plane if its center is further behind the plane than
+	// its projected radius. It's visible if it's not fully outside of at
+	// least one of the views.
+	int32_t  visible     = 0;
+	XMVECTOR zero        = XMVectorZero();
+	XMVECTOR one         = XMVectorSplatOne();
+	XMVECTOR depth_scale = depth != nullptr ? XMVectorReplicate(1.0f / depth->far_plane) : zero;
+	for (int32_t g = 0; g < group_count; g++) {
+		const render_cull_group_t &group = render_cull_groups[g];
+		XMVECTOR cx = XMLoadFloat4(&group.center_x);
+		XMVECTOR cy = XMLoadFloat4(&group.center_y);
+		XMVECTOR cz = XMLoadFloat4(&group.center_z);
+		XMVECTOR ex = XMLoadFloat4(&group.extent_x);
+		XMVECTOR ey = XMLoadFloat4(&group.extent_y);
+		XMVECTOR ez = XMLoadFloat4(&group.extent_z);
+
+		XMVECTOR in_any = XMVectorFalseInt();
+		for (int32_t v = 0; v < view_count; v++) {
+			XMVECTOR outside = XMVectorFalseInt();
+			for (int32_t p = 0; p < 6; p++) {
+				XMVECTOR plane  = planes[v][p];
+				XMVECTOR abs_pl = XMVectorAbs(plane);
+				XMVECTOR dist   = XMVectorMultiplyAdd(cx, XMVectorSplatX(plane), XMVectorSplatW(plane));
+				dist = XMVectorMultiplyAdd(cy, XMVectorSplatY(plane), dist);
+				dist = XMVectorMultiplyAdd(cz, XMVectorSplatZ(plane), dist);
+				XMVECTOR radius = XMVectorMultiply   (ex, XMVectorSplatX(abs_pl));
+				radius = XMVectorMultiplyAdd(ey, XMVectorSplatY(abs_pl), radius);
+				radius = XMVectorMultiplyAdd(ez, XMVectorSplatZ(abs_pl), radius);
+				outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(dist, radius), zero));
+			}
+			in_any = XMVectorOrInt(in_any, XMVectorAndCInt(XMVectorTrueInt(), outside));
+		}
+
+		// Distance along the view direction, scaled to 0-1 by the far plane
+		XMFLOAT4 depth01 = {};
+		if (depth != nullptr) {
+			XMVECTOR d = XMVectorMultiply(XMVectorSubtract(cx, XMVectorSplatX(depth->cam_pos)), XMVectorSplatX(depth->cam_dir));
+			d = XMVectorMultiplyAdd(XMVectorSubtract(cy, XMVectorSplatY(depth->cam_pos)), XMVectorSplatY(depth->cam_dir), d);
+			d = XMVectorMultiplyAdd(XMVectorSubtract(cz, XMVectorSplatZ(depth->cam_pos)), XMVectorSplatZ(depth->cam_dir), d);
+			XMStoreFloat4(&depth01, XMVectorClamp(XMVectorMultiply(d, depth_scale), zero, one));
+		}
+
+		uint32_t mask[4];
+		XMStoreInt4(mask, in_any);
+		for (int32_t lane = 0; lane < 4; lane++) {
+			int32_t i = g * 4 + lane;
+			if (i >= count || mask[lane] == 0)
+				continue;
+			out_keys[visible].sort_id = depth != nullptr
+				? render_cull_depth_key(items[i], (&depth01.x)[lane])
+				: items[i].sort_id;
+			out_keys[visible].index   = (uint32_t)i;
+			visible += 1;
+		}
+	}
+	return visible;
+}
+
+///////////////////////////////////////////
+
+void render_cull_shutdown() {
+	render_cull_groups.free();
+}
+
+} // namespace sk
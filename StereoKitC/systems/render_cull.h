@@ -0,0 +1,18 @@
+#pragma once
+
+#include "render.h"
+
+namespace sk {
+
+// When provided, the culling pass also folds each visible item's distance
+// along the view direction into its sort key.
+struct render_cull_depth_t {
+	DirectX::XMVECTOR cam_pos;
+	DirectX::XMVECTOR cam_dir;
+	float             far_plane;
+};
+
+int32_t render_cull_frustum(const render_item_t *items, int32_t count, const DirectX::XMMATRIX *viewprojs, int32_t view_count, const render_cull_depth_t *depth, render_sort_key_t *out_keys);
+void    render_cull_shutdown();
+
+} // namespace sk
@@ -0,0 +1,356 @@
+#include "render_d3d11.h"
+#include "d3d.h"
+#include "../math.h"
+#include "../libraries/array.h"
+#include "../asset_types/mesh.h"
+#include "../asset_types/texture.h"
+#include "../asset_types/shader.h"
+#include "../asset_types/material.h"
+
+#include <d3d11_1.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct render_blit_data_t {
+	float width;
+	float height;
+	float pixel_width;
+	float pixel_height;
+};
+
+///////////////////////////////////////////
+
+// Instance data for each execute is uploaded into a single ring buffer
+// with one Map, and each draw binds its own window of it using D3D11.1
+// constant buffer offsets. Offsets and sizes are counted in 16 byte
+// constants, and the offsets need to be a multiple of 16 constants.
+const UINT render_d3d11_inst_slot     = 1;
+const UINT render_d3d11_cb_align      = 256;
+const UINT render_d3d11_ring_min_size = 1024 * 1024;
+
+shaderargs_t          render_d3d11_globals;
+shaderargs_t          render_d3d11_blit_args;
+shaderargs_t          render_d3d11_inst_fallback;
+ID3D11DeviceContext1 *render_d3d11_context1    = nullptr;
+ID3D11Buffer         *render_d3d11_ring        = nullptr;
+UINT                  render_d3d11_ring_size   = 0;
+UINT                  render_d3d11_ring_offset = 0;
+array_t<UINT>         render_d3d11_ring_starts = {};
+// Once the device refuses a ring buffer, anything that doesn't fit the
+// current one just stays on the per-draw fallback.
+bool                  render_d3d11_ring_failed = false;
+
+material_t render_d3d11_last_material;
+shader_t   render_d3d11_last_shader;
+mesh_t     render_d3d11_last_mesh;
+
+// Whatever was bound before target_begin, so target_end can put it back
+D3D11_VIEWPORT          render_d3d11_prev_viewport       = {};
+UINT                    render_d3d11_prev_viewport_count = 0;
+ID3D11RenderTargetView *render_d3d11_prev_target         = nullptr;
+ID3D11DepthStencilView *render_d3d11_prev_depth          = nullptr;
+
+///////////////////////////////////////////
+
+void render_d3d11_set_material(material_t material);
+void render_d3d11_set_shader  (shader_t   shader);
+void render_d3d11_set_mesh    (mesh_t     mesh);
+void render_d3d11_set_inst    (const render_transform_buffer_t *instances, int32_t count);
+void render_d3d11_ring_resize (UINT size);
+bool render_d3d11_ring_upload (const render_cmd_t *commands, int32_t command_count, const render_transform_buffer_t *instances);
+void render_d3d11_ring_bind   (UINT start, int32_t count);
+
+///////////////////////////////////////////
+
+bool render_d3d11_init() {
+	shaderargs_create(render_d3d11_globals,   sizeof(render_global_buffer_t), 0);
+	shaderargs_create(render_d3d11_blit_args, sizeof(render_blit_data_t),     1);
+
+	// Without constant buffer offsets, we fall back to uploading each
+	// draw's instances into a single buffer right before the draw. The
+	// ring can also fall back on it if it ever fails to map.
+	shaderargs_create(render_d3d11_inst_fallback, sizeof(render_transform_buffer_t) * render_instance_max, render_d3d11_inst_slot);
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	if (SUCCEEDED(d3d_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+		options.ConstantBufferOffsetting &&
+		options.MapNoOverwriteOnDynamicConstantBuffer &&
+		SUCCEEDED(d3d_context->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&render_d3d11_context1))) {
+		render_d3d11_ring_resize(render_d3d11_ring_min_size);
+	} else {
+		log_info("Constant buffer offsets aren't supported, instance data will be uploaded per draw.");
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_shutdown() {
+	if (render_d3d11_ring     != nullptr) { render_d3d11_ring    ->Release(); render_d3d11_ring     = nullptr; }
+	if (render_d3d11_context1 != nullptr) { render_d3d11_context1->Release(); render_d3d11_context1 = nullptr; }
+	render_d3d11_ring_size   = 0;
+	render_d3d11_ring_offset = 0;
+	render_d3d11_ring_failed = false;
+	render_d3d11_ring_starts.free();
+
+	shaderargs_destroy(render_d3d11_inst_fallback);
+	shaderargs_destroy(render_d3d11_blit_args);
+	shaderargs_destroy(render_d3d11_globals);
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_begin_queue(const render_global_buffer_t &globals, tex_t sky_cubemap) {
+	render_d3d11_last_material = nullptr;
+	render_d3d11_last_shader   = nullptr;
+	render_d3d11_last_mesh     = nullptr;
+
+	shaderargs_set_data  (render_d3d11_globals, (void*)&globals);
+	shaderargs_set_active(render_d3d11_globals);
+	d3d_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	if (sky_cubemap != nullptr) {
+		d3d_context->VSSetSamplers       (11, 1, &sky_cubemap->sampler);
+		d3d_context->VSSetShaderResources(11, 1, &sky_cubemap->resource);
+		d3d_context->PSSetSamplers       (11, 1, &sky_cubemap->sampler);
+		d3d_context->PSSetShaderResources(11, 1, &sky_cubemap->resource);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_execute(const render_cmd_t *commands, int32_t command_count, const render_transform_buffer_t *instances, int32_t instance_count) {
+	// Anything that goes wrong with the ring falls back on the regular
+	// per-draw constant buffer.
+	bool use_ring =
+		render_d3d11_context1 != nullptr &&
+		render_d3d11_ring_upload(commands, command_count, instances);
+
+	int32_t upload = 0;
+	for (int32_t i = 0; i < command_count; i++) {
+		const render_cmd_t &cmd = commands[i];
+		switch (cmd.type) {
+		case render_cmd_material:  render_d3d11_set_material(cmd.material); break;
+		case render_cmd_mesh:      render_d3d11_set_mesh    (cmd.mesh);     break;
+		case render_cmd_instances: {
+			if (use_ring) render_d3d11_ring_bind(render_d3d11_ring_starts[upload], cmd.instances.count);
+			else          render_d3d11_set_inst (&instances[cmd.instances.start], cmd.instances.count);
+			upload += 1;
+		} break;
+		case render_cmd_draw:      d3d_context->DrawIndexedInstanced(render_d3d11_last_mesh->ind_draw, cmd.draw_count, 0, 0, 0); break;
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_blit(tex_t to, material_t material, mesh_t quad) {
+	render_d3d11_target_begin(to, to->width, to->height, { 0,0,0,0 });
+
+	// Setup shader args for the blit operation
+	render_blit_data_t data = {};
+	data.width  = (float)to->width;
+	data.height = (float)to->height;
+	data.pixel_width  = 1.0f / to->width;
+	data.pixel_height = 1.0f / to->height;
+
+	// Setup render states for blitting
+	shaderargs_set_data  (render_d3d11_blit_args, &data);
+	shaderargs_set_active(render_d3d11_blit_args);
+	render_d3d11_set_material(material);
+	render_d3d11_set_mesh    (quad);
+
+	// And draw to it!
+	d3d_context->DrawIndexedInstanced(quad->ind_draw, 1, 0, 0, 0);
+
+	render_d3d11_target_end();
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_target_begin(tex_t target, int32_t width, int32_t height, color32 clear_color) {
+	// Hang on to the current target, this often happens in the middle of
+	// drawing to something else.
+	render_d3d11_prev_viewport_count = 1;
+	d3d_context->RSGetViewports    (&render_d3d11_prev_viewport_count, &render_d3d11_prev_viewport);
+	d3d_context->OMGetRenderTargets(1, &render_d3d11_prev_target, &render_d3d11_prev_depth);
+
+	// Set up where on the render target we want to draw
+	D3D11_VIEWPORT viewport = CD3D11_VIEWPORT(0.f, 0.f, (float)width, (float)height);
+	d3d_context->RSSetViewports(1, &viewport);
+
+	// Wipe the target clean, and then set it up for rendering!
+	tex_rtarget_clear     (target, clear_color);
+	tex_rtarget_set_active(target);
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_target_end() {
+	d3d_context->OMSetRenderTargets(1, &render_d3d11_prev_target, render_d3d11_prev_depth);
+	if (render_d3d11_prev_viewport_count > 0)
+		d3d_context->RSSetViewports(render_d3d11_prev_viewport_count, &render_d3d11_prev_viewport);
+	if (render_d3d11_prev_target != nullptr) { render_d3d11_prev_target->Release(); render_d3d11_prev_target = nullptr; }
+	if (render_d3d11_prev_depth  != nullptr) { render_d3d11_prev_depth ->Release(); render_d3d11_prev_depth  = nullptr; }
+
+	render_d3d11_last_material = nullptr;
+	render_d3d11_last_shader   = nullptr;
+	render_d3d11_last_mesh     = nullptr;
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_set_material(material_t material) {
+	if (material == render_d3d11_last_material)
+		return;
+	render_d3d11_last_material = material;
+
+	render_d3d11_set_shader(material->shader);
+	shaderargs_set_data    (material->shader->args, material->args.buffer);
+	shaderargs_set_active  (material->shader->args);
+
+	// Fill an array of texture data so we can set them all at the same time
+	ID3D11SamplerState       *samplers [10];
+	ID3D11ShaderResourceView *resources[10];
+	assert(material->shader->tex_slots.tex_count < 10);
+
+	// Use a texture from the material, or use the default! But don't
+	// leave any empty, or we can get overflow from previous renders.
+	for (int i = 0; i < material->shader->tex_slots.tex_count; i++) {
+		tex_t tex = material->args.textures[i];
+		if (tex == nullptr)
+			tex = material->shader->tex_slots.tex[i].default_tex;
+
+		samplers [i] = tex->sampler;
+		resources[i] = tex->resource;
+	}
+	if (material->shader->tex_slots.tex_count != 0) {
+		d3d_context->PSSetSamplers       (0, material->shader->tex_slots.tex_count, samplers);
+		d3d_context->PSSetShaderResources(0, material->shader->tex_slots.tex_count, resources);
+		d3d_context->VSSetSamplers       (0, material->shader->tex_slots.tex_count, samplers);
+		d3d_context->VSSetShaderResources(0, material->shader->tex_slots.tex_count, resources);
+	}
+
+	if (material->alpha_mode == transparency_none) {
+		d3d_context->OMSetBlendState(0,0, 0xFFFFFFFF);
+	} else {
+		d3d_context->OMSetBlendState(material->blend_state, nullptr, 0xFFFFFFFF);
+	}
+	if (material->rasterizer_state != nullptr) {
+		d3d_context->RSSetState(material->rasterizer_state);
+	} else {
+		d3d_context->RSSetState(d3d_rasterstate);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_set_shader(shader_t shader) {
+	if (shader == render_d3d11_last_shader)
+		return;
+	render_d3d11_last_shader = shader;
+
+	d3d_context->VSSetShader(shader->vshader, nullptr, 0);
+	d3d_context->PSSetShader(shader->pshader, nullptr, 0);
+	d3d_context->IASetInputLayout(shader->vert_layout);
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_set_mesh(mesh_t mesh) {
+	if (mesh == render_d3d11_last_mesh)
+		return;
+	render_d3d11_last_mesh = mesh;
+
+	UINT strides[] = { sizeof(vert_t) };
+	UINT offsets[] = { 0 };
+	d3d_context->IASetVertexBuffers(0, 1, &mesh->vert_buffer, strides, offsets);
+#ifdef SK_32BIT_INDICES
+	d3d_context->IASetIndexBuffer  (mesh->ind_buffer, DXGI_FORMAT_R32_UINT, 0);
+#else
+	d3d_context->IASetIndexBuffer  (mesh->ind_buffer, DXGI_FORMAT_R16_UINT, 0);
+#endif
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_set_inst(const render_transform_buffer_t *instances, int32_t count) {
+	shaderargs_set_data  (render_d3d11_inst_fallback, (void*)instances, sizeof(render_transform_buffer_t) * count);
+	shaderargs_set_active(render_d3d11_inst_fallback, false);
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_ring_resize(UINT size) {
+	// The old ring stays put if this fails, it can still take anything
+	// that fits.
+	ID3D11Buffer      *ring = nullptr;
+	CD3D11_BUFFER_DESC desc(size, D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+	if (FAILED(d3d_device->CreateBuffer(&desc, nullptr, &ring))) {
+		log_err("render_d3d11: Failed to create the instance ring buffer, larger lists will upload per draw.");
+		render_d3d11_ring_failed = true;
+		return;
+	}
+	if (render_d3d11_ring != nullptr) render_d3d11_ring->Release();
+	render_d3d11_ring = ring;
+	DX11ResType(render_d3d11_ring, "instance_ring");
+
+	// Start out "full", so the first upload maps with a discard
+	render_d3d11_ring_size   = size;
+	render_d3d11_ring_offset = size;
+}
+
+///////////////////////////////////////////
+
+bool render_d3d11_ring_upload(const render_cmd_t *commands, int32_t command_count, const render_transform_buffer_t *instances) {
+	render_d3d11_ring_starts.clear();
+
+	UINT total = 0;
+	for (int32_t i = 0; i < command_count; i++) {
+		if (commands[i].type != render_cmd_instances) continue;
+		UINT size = (UINT)(sizeof(render_transform_buffer_t) * commands[i].instances.count);
+		total += (size + render_d3d11_cb_align - 1) & ~(render_d3d11_cb_align - 1);
+	}
+	if (total == 0)
+		return true;
+
+	// Append to the end of the ring while there's room, the GPU may still
+	// be reading what's before it. Once it fills up, discard and wrap back
+	// around to the start.
+	if (total > render_d3d11_ring_size && !render_d3d11_ring_failed)
+		render_d3d11_ring_resize(maxi(total, render_d3d11_ring_size * 2));
+	if (render_d3d11_ring == nullptr || total > render_d3d11_ring_size)
+		return false;
+	D3D11_MAP map_type = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if (render_d3d11_ring_offset + total > render_d3d11_ring_size) {
+		map_type                 = D3D11_MAP_WRITE_DISCARD;
+		render_d3d11_ring_offset = 0;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE res;
+	if (FAILED(d3d_context->Map(render_d3d11_ring, 0, map_type, 0, &res))) {
+		log_err("render_d3d11: Failed to map the instance ring buffer!");
+		return false;
+	}
+	for (int32_t i = 0; i < command_count; i++) {
+		if (commands[i].type != render_cmd_instances) continue;
+		UINT size = (UINT)(sizeof(render_transform_buffer_t) * commands[i].instances.count);
+		memcpy((uint8_t*)res.pData + render_d3d11_ring_offset, &instances[commands[i].instances.start], size);
+		render_d3d11_ring_starts.add(render_d3d11_ring_offset);
+		render_d3d11_ring_offset += (size + render_d3d11_cb_align - 1) & ~(render_d3d11_cb_align - 1);
+	}
+	d3d_context->Unmap(render_d3d11_ring, 0);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void render_d3d11_ring_bind(UINT start, int32_t count) {
+	UINT size      = (UINT)(sizeof(render_transform_buffer_t) * count);
+	UINT first     = start / 16;
+	UINT constants = ((size + render_d3d11_cb_align - 1) & ~(render_d3d11_cb_align - 1)) / 16;
+	render_d3d11_context1->VSSetConstantBuffers1(render_d3d11_inst_slot, 1, &render_d3d11_ring, &first, &constants);
+}
+
+} // namespace sk
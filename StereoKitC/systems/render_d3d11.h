@@ -0,0 +1,15 @@
+#pragma once
+
+#include "render.h"
+
+namespace sk {
+
+bool render_d3d11_init        ();
+void render_d3d11_shutdown    ();
+void render_d3d11_begin_queue (const render_global_buffer_t &globals, tex_t sky_cubemap);
+void render_d3d11_execute     (const render_cmd_t *commands, int32_t command_count, const render_transform_buffer_t *instances, int32_t instance_count);
+void render_d3d11_blit        (tex_t to, material_t material, mesh_t quad);
+void render_d3d11_target_begin(tex_t target, int32_t width, int32_t height, color32 clear_color);
+void render_d3d11_target_end  ();
+
+} // namespace sk
@@ -0,0 +1,112 @@
+#include "render_null.h"
+
+namespace sk {
+
+///////////////////////////////////////////
+
+render_null_counts_t render_null_counts = {};
+
+///////////////////////////////////////////
+
+bool render_null_init() {
+	render_null_counts = {};
+	return true;
+}
+
+///////////////////////////////////////////
+
+void render_null_shutdown() {
+}
+
+///////////////////////////////////////////
+
+void render_null_begin_queue(const render_global_buffer_t &, tex_t) {
+	render_null_counts.queues += 1;
+}
+
+///////////////////////////////////////////
+
+void render_null_execute(const render_cmd_t *commands, int32_t command_count, const render_transform_buffer_t *instances, int32_t instance_count) {
+	// Walk the command stream the same way a real backend would, and make
+	// sure each command has everything it needs bound before it runs.
+	material_t  material = nullptr;
+	mesh_t      mesh     = nullptr;
+	int32_t     uploaded = 0;
+	const char *error    = nullptr;
+
+	for (int32_t i = 0; i < command_count && error == nullptr; i++) {
+		const render_cmd_t &cmd = commands[i];
+		switch (cmd.type) {
+		case render_cmd_material: {
+			render_null_counts.cmd_material += 1;
+			material = cmd.material;
+			if (material == nullptr) error = "material command with a null material";
+		} break;
+		case render_cmd_mesh: {
+			render_null_counts.cmd_mesh += 1;
+			mesh = cmd.mesh;
+			if (mesh == nullptr) error = "mesh command with a null mesh";
+		} break;
+		case render_cmd_instances: {
+			render_null_counts.cmd_instances += 1;
+			uploaded = cmd.instances.count;
+			if (cmd.instances.count <= 0 || cmd.instances.count > render_instance_max)
+				error = "instance upload with an invalid count";
+			else if (cmd.instances.start < 0 || cmd.instances.start + cmd.instances.count > instance_count)
+				error = "instance upload outside of the instance list";
+			else {
+				for (int32_t t = 0; t < cmd.instances.count; t++) {
+					if (instances[cmd.instances.start + t].view_id > 1) {
+						error = "instance with an invalid view id";
+						break;
+					}
+				}
+			}
+		} break;
+		case render_cmd_draw: {
+			render_null_counts.cmd_draw  += 1;
+			render_null_counts.instances += cmd.draw_count;
+			if      (material == nullptr)          error = "draw without a material";
+			else if (mesh     == nullptr)          error = "draw without a mesh";
+			else if (cmd.draw_count != uploaded)   error = "draw count doesn't match the uploaded instances";
+		} break;
+		default: error = "unknown command type"; break;
+		}
+	}
+
+	if (error != nullptr) {
+		render_null_counts.errors += 1;
+		log_errf("render_null: invalid command stream, %s!", error);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_null_blit(tex_t, material_t, mesh_t) {
+	render_null_counts.blits += 1;
+}
+
+///////////////////////////////////////////
+
+void render_null_target_begin(tex_t, int32_t, int32_t, color32) {
+	render_null_counts.targets += 1;
+}
+
+///////////////////////////////////////////
+
+void render_null_target_end() {
+}
+
+///////////////////////////////////////////
+
+render_null_counts_t render_null_get_counts() {
+	return render_null_counts;
+}
+
+///////////////////////////////////////////
+
+void render_null_reset_counts() {
+	render_null_counts = {};
+}
+
+} // namespace sk
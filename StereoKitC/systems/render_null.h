@@ -0,0 +1,30 @@
+#pragma once
+
+#include "render.h"
+
+namespace sk {
+
+struct render_null_counts_t {
+	int32_t queues;
+	int32_t cmd_material;
+	int32_t cmd_mesh;
+	int32_t cmd_instances;
+	int32_t cmd_draw;
+	int32_t instances;
+	int32_t blits;
+	int32_t targets;
+	int32_t errors;
+};
+
+bool render_null_init        ();
+void render_null_shutdown    ();
+void render_null_begin_queue (const render_global_buffer_t &globals, tex_t sky_cubemap);
+void render_null_execute     (const render_cmd_t *commands, int32_t command_count, const render_transform_buffer_t *instances, int32_t instance_count);
+void render_null_blit        (tex_t to, material_t material, mesh_t quad);
+void render_null_target_begin(tex_t target, int32_t width, int32_t height, color32 clear_color);
+void render_null_target_end  ();
+
+render_null_counts_t render_null_get_counts  ();
+void                 render_null_reset_counts();
+
+} // namespace sk
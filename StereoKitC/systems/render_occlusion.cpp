@@ -0,0 +1,227 @@
+#include "render_occlusion.h"
+#include "memory_track.h"
+#include "../math.h"
+#include "../asset_types/mesh.h"
+
+#include <float.h>
+#include <directxmath.h>
+using namespace DirectX;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// The depth buffer is tiny, and rasterized 4 pixels at a time. Each
+// triangle is written with its farthest depth, so the buffer only ever
+// holds depths that are at or behind the real surfaces. That keeps the
+// test conservative, nothing visible can be culled by it.
+const int32_t render_occ_width   = 256;
+const int32_t render_occ_height  = 128;
+const int32_t render_occ_tile    = 8;
+const int32_t render_occ_tiles_x = render_occ_width  / render_occ_tile;
+const int32_t render_occ_tiles_y = render_occ_height / render_occ_tile;
+const float   render_occ_near_w  = 0.0001f;
+
+struct render_occ_view_t {
+	XMMATRIX viewproj;
+	float   *depth;
+	float   *tiles;
+};
+
+// Per thread, like the culling scratch memory
+thread_local render_occ_view_t render_occ_views[2]   = {};
+thread_local int32_t           render_occ_view_count = 0;
+
+///////////////////////////////////////////
+
+void render_occlusion_triangle(float *depth, XMFLOAT4 a, XMFLOAT4 b, XMFLOAT4 c) {
+	// Make the winding consistent, so the edge functions are positive on
+	// the inside no matter which way the triangle faces.
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (area == 0) return;
+	if (area < 0) { XMFLOAT4 t = b; b = c; c = t; }
+
+	int32_t min_x = maxi((int32_t)fminf(a.x, fminf(b.x, c.x)), 0);
+	int32_t max_x = mini((int32_t)fmaxf(a.x, fmaxf(b.x, c.x)) + 1, render_occ_width  - 1);
+	int32_t min_y = maxi((int32_t)fminf(a.y, fminf(b.y, c.y)), 0);
+	int32_t max_y = mini((int32_t)fmaxf(a.y, fmaxf(b.y, c.y)) + 1, render_occ_height - 1);
+	if (min_x > max_x || min_y > max_y) return;
+	min_x &= ~3;
+
+	// Anything in front of the near plane gets clipped on the GPU, so it
+	// can't hide anything either.
+	float max_z = fmaxf(a.z, fmaxf(b.z, c.z));
+	if (max_z < 0) return;
+	XMVECTOR tri_z = XMVectorReplicate(max_z);
+
+	// Edge functions: e(x,y) = dx*x + dy*y + c, evaluated at pixel centers
+	float ex[3] = { a.y - b.y, b.y - c.y, c.y - a.y };
+	float ey[3] = { b.x - a.x, c.x - b.x, a.x - c.x };
+	float ec[3] = {
+		a.x * b.y - a.y * b.x,
+		b.x * c.y - b.y * c.x,
+		c.x * a.y - c.y * a.x };
+
+	XMVECTOR zero   = XMVectorZero();
+	XMVECTOR lane_x = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	for (int32_t y = min_y; y <= max_y; y++) {
+		float    py  = y + 0.5f;
+		float   *row = &depth[y * render_occ_width];
+		XMVECTOR e_start[3], e_step[3];
+		for (int32_t e = 0; e < 3; e++) {
+			e_start[e] = XMVectorMultiplyAdd(XMVectorReplicate(ex[e]), XMVectorAdd(lane_x, XMVectorReplicate((float)min_x)), XMVectorReplicate(ey[e] * py + ec[e]));
+			e_step [e] = XMVectorReplicate(ex[e] * 4);
+		}
+
+		for (int32_t x = min_x; x <= max_x; x += 4) {
+			XMVECTOR inside = XMVectorAndInt(
+				XMVectorGreaterOrEqual(e_start[0], zero), XMVectorAndInt(
+				XMVectorGreaterOrEqual(e_start[1], zero),
+				XMVectorGreaterOrEqual(e_start[2], zero)));
+
+			XMVECTOR curr = XMLoadFloat4((XMFLOAT4*)&row[x]);
+			XMStoreFloat4((XMFLOAT4*)&row[x], XMVectorSelect(curr, XMVectorMin(curr, tri_z), inside));
+
+			for (int32_t e = 0; e < 3; e++)
+				e_start[e] = XMVectorAdd(e_start[e], e_step[e]);
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void render_occlusion_rasterize(const render_occluder_t *occluders, int32_t occluder_count, const XMMATRIX *viewprojs, int32_t view_count) {
+	render_occ_view_count = view_count;
+
+	for (int32_t v = 0; v < view_count; v++) {
+		render_occ_view_t &view = render_occ_views[v];
+		if (view.depth == nullptr) {
+			memory_scope(memory_tag_render);
+			view.depth = (float*)sk_malloc(sizeof(float) * render_occ_width   * render_occ_height);
+			view.tiles = (float*)sk_malloc(sizeof(float) * render_occ_tiles_x * render_occ_tiles_y);
+		}
+		view.viewproj = viewprojs[v];
+		for (int32_t i = 0; i < render_occ_width * render_occ_height; i++)
+			view.depth[i] = 1;
+
+		for (int32_t o = 0; o < occluder_count; o++) {
+			mesh_t mesh = occluders[o].mesh;
+			if (mesh->verts == nullptr || mesh->inds == nullptr)
+				continue;
+
+			XMMATRIX transform = occluders[o].transform * view.viewproj;
+			for (int32_t i = 0; i < mesh->ind_count; i += 3) {
+				XMFLOAT4 pts[3];
+				bool     clipped = false;
+				for (int32_t p = 0; p < 3; p++) {
+					XMVECTOR pt = XMVector3Transform(XMLoadFloat3((XMFLOAT3*)&mesh->verts[mesh->inds[i + p]].pos), transform);
+					XMStoreFloat4(&pts[p], pt);
+					// Skipping triangles that cross the near plane just means
+					// less gets occluded, which is always safe.
+					if (pts[p].w < render_occ_near_w) { clipped = true; break; }
+					float inv_w = 1.0f / pts[p].w;
+					pts[p].x = ( pts[p].x * inv_w * 0.5f + 0.5f) * render_occ_width;
+					pts[p].y = (-pts[p].y * inv_w * 0.5f + 0.5f) * render_occ_height;
+					pts[p].z =   pts[p].z * inv_w;
+				}
+				if (!clipped)
+					render_occlusion_triangle(view.depth, pts[0], pts[1], pts[2]);
+			}
+		}
+
+		// Build a coarse level with the farthest depth of each tile, which
+		// is all the bounds test needs.
+		for (int32_t ty = 0; ty < render_occ_tiles_y; ty++) {
+			for (int32_t tx = 0; tx < render_occ_tiles_x; tx++) {
+				XMVECTOR tile_max = XMVectorZero();
+				for (int32_t y = 0; y < render_occ_tile; y++) {
+					const float *row = &view.depth[(ty * render_occ_tile + y) * render_occ_width + tx * render_occ_tile];
+					for (int32_t x = 0; x < render_occ_tile; x += 4)
+						tile_max = XMVectorMax(tile_max, XMLoadFloat4((XMFLOAT4*)&row[x]));
+				}
+				XMFLOAT4 m;
+				XMStoreFloat4(&m, tile_max);
+				view.tiles[ty * render_occ_tiles_x + tx] = fmaxf(fmaxf(m.x, m.y), fmaxf(m.z, m.w));
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+bool render_occlusion_test(const render_occ_view_t &view, const bounds_t &bounds, const XMMATRIX &world) {
+	XMMATRIX transform = world * view.viewproj;
+	XMVECTOR center    = XMLoadFloat3((XMFLOAT3*)&bounds.center);
+	XMVECTOR half      = XMVectorScale(XMLoadFloat3((XMFLOAT3*)&bounds.dimensions), 0.5f);
+
+	// Find the screen rectangle and nearest depth of the box's corners
+	float min_x = FLT_MAX, min_y = FLT_MAX, min_z = FLT_MAX;
+	float max_x = -FLT_MAX, max_y = -FLT_MAX;
+	for (int32_t i = 0; i < 8; i++) {
+		XMVECTOR sign = XMVectorSet(
+			(i & 1) ? 1.f : -1.f,
+			(i & 2) ? 1.f : -1.f,
+			(i & 4) ? 1.f : -1.f, 0);
+		XMFLOAT4 pt;
+		XMStoreFloat4(&pt, XMVector3Transform(XMVectorMultiplyAdd(half, sign, center), transform));
+		if (pt.w < render_occ_near_w)
+			return true;
+
+		float inv_w = 1.0f / pt.w;
+		float x = ( pt.x * inv_w * 0.5f + 0.5f) * render_occ_width;
+		float y = (-pt.y * inv_w * 0.5f + 0.5f) * render_occ_height;
+		min_x = fminf(min_x, x); max_x = fmaxf(max_x, x);
+		min_y = fminf(min_y, y); max_y = fmaxf(max_y, y);
+		min_z = fminf(min_z, pt.z * inv_w);
+	}
+
+	int32_t tx0 = maxi((int32_t)min_x / render_occ_tile, 0);
+	int32_t ty0 = maxi((int32_t)min_y / render_occ_tile, 0);
+	int32_t tx1 = mini((int32_t)max_x / render_occ_tile, render_occ_tiles_x - 1);
+	int32_t ty1 = mini((int32_t)max_y / render_occ_tile, render_occ_tiles_y - 1);
+	if (tx0 > tx1 || ty0 > ty1)
+		return true;
+
+	for (int32_t ty = ty0; ty <= ty1; ty++) {
+		for (int32_t tx = tx0; tx <= tx1; tx++) {
+			if (min_z <= view.tiles[ty * render_occ_tiles_x + tx])
+				return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+
+int32_t render_occlusion_cull(const render_item_t *items, render_sort_key_t *keys, int32_t key_count) {
+	// Compacts the keys in place, so whatever order they had is kept
+	int32_t visible = 0;
+	for (int32_t i = 0; i < key_count; i++) {
+		const render_item_t &item   = items[keys[i].index];
+		const bounds_t      &bounds = item.mesh->bounds;
+
+		// Only hidden if it's hidden from every view
+		bool is_visible = bounds.dimensions.x == 0 && bounds.dimensions.y == 0 && bounds.dimensions.z == 0;
+		for (int32_t v = 0; !is_visible && v < render_occ_view_count; v++)
+			is_visible = render_occlusion_test(render_occ_views[v], bounds, item.transform);
+
+		if (is_visible) {
+			keys[visible] = keys[i];
+			visible += 1;
+		}
+	}
+	return visible;
+}
+
+///////////////////////////////////////////
+
+void render_occlusion_shutdown() {
+	for (int32_t v = 0; v < _countof(render_occ_views); v++) {
+		sk_free(render_occ_views[v].depth);
+		sk_free(render_occ_views[v].tiles);
+		render_occ_views[v] = {};
+	}
+	render_occ_view_count = 0;
+}
+
+} // namespace sk
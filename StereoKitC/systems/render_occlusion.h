@@ -0,0 +1,11 @@
+#pragma once
+
+#include "render.h"
+
+namespace sk {
+
+void    render_occlusion_rasterize(const render_occluder_t *occluders, int32_t occluder_count, const DirectX::XMMATRIX *viewprojs, int32_t view_count);
+int32_t render_occlusion_cull     (const render_item_t *items, render_sort_key_t *keys, int32_t key_count);
+void    render_occlusion_shutdown ();
+
+} // namespace sk
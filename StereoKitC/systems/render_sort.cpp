@@ -1,15 +1,12 @@
 // https://travisdowns.github.io/blog/2019/05/22/sorting.html
 
 #include "render_sort.h"
+#include "profiler.h"
+#include "frame_alloc.h"
 
 #include <algorithm>
-#include <memory>
-#include <array>
 #include <assert.h>
 #include <string.h>
-#include <assert.h>
-
-#include <intrin.h>
 
 using namespace sk;
 
@@ -20,9 +17,7 @@ const uint64_t RADIX_MASK   = RADIX_SIZE - 1;
 
 using freq_array_type = size_t [RADIX_LEVELS][RADIX_SIZE];
 
-// never inline just to make it show up easily in profiles (inlining this lengthly function doesn't
-// really help anyways)
-static void count_frequency(render_item_t *a, size_t count, freq_array_type freqs) {
+static void count_frequency(render_sort_key_t *a, size_t count, freq_array_type freqs) {
 	for (size_t i = 0; i < count; i++) {
 		uint64_t value = a[i].sort_id;
 		for (size_t pass = 0; pass < RADIX_LEVELS; pass++) {
@@ -50,54 +45,48 @@ static bool is_trivial(size_t freqs[RADIX_SIZE], size_t count) {
 	return true;
 }
 
-void radix_sort7(render_item_t *a, size_t count)
-{
+///////////////////////////////////////////
 
-	std::unique_ptr<render_item_t[]> queue_area(new render_item_t[count]);
-	// huge_unique_ptr<uint64_t[]> queue_area = make_huge_array<uint64_t>(count, false);
+// An LSD radix sort that only shuffles around the compact
+// (sort_id, index) pairs in scratch.keys, which the caller fills with the
+// items it wants drawn. The sorted keys end up back in scratch.keys, and
+// the caller can use the indices to look up the full items. The keys stick
+// around between frames, and the temporary buffer comes from the thread's
+// scratch arena, so this doesn't hit the heap after warming up.
+void radix_sort_keys(render_sort_scratch_t &scratch) {
+	profile_zone("render_sort");
+	int32_t      count = scratch.keys.count;
+	frame_mark_t mark  = frame_scratch_mark();
 
 	freq_array_type freqs = {};
-	count_frequency(a, count, freqs);
+	count_frequency(scratch.keys.data, count, freqs);
 
-	render_item_t *from = a, *to = queue_area.get();
+	render_sort_key_t *from = scratch.keys.data, *to = (render_sort_key_t*)frame_scratch_alloc(sizeof(render_sort_key_t) * count);
 
 	for (size_t pass = 0; pass < RADIX_LEVELS; pass++) {
-
-		if (is_trivial(freqs[pass], count)) {
-			// this pass would do nothing, just skip it
+		if (is_trivial(freqs[pass], count))
 			continue;
-		}
 
 		uint64_t shift = pass * RADIX_BITS;
 
-		// array of pointers to the current position in each queue, which we set up based on the
-		// known final sizes of each queue (i.e., "tighly packed")
-		render_item_t * queue_ptrs[RADIX_SIZE], * next = to;
+		render_sort_key_t *queue_ptrs[RADIX_SIZE], *next = to;
 		for (size_t i = 0; i < RADIX_SIZE; i++) {
 			queue_ptrs[i] = next;
 			next += freqs[pass][i];
 		}
 
-		// copy each element into the appropriate queue based on the current RADIX_BITS sized
-		// "digit" within it
-		for (size_t i = 0; i < count; i++) {
-			render_item_t value = from[i];
+		for (int32_t i = 0; i < count; i++) {
+			render_sort_key_t value = from[i];
 			size_t index = (value.sort_id >> shift) & RADIX_MASK;
 			*queue_ptrs[index]++ = value;
-#ifdef _M_ARM
-			__prefetch (queue_ptrs[index] + 1);
-#elif !defined(WINDOWS_UWP)
-			_m_prefetch(queue_ptrs[index] + 1);
-#endif
 		}
 
-		// swap from and to areas
 		std::swap(from, to);
 	}
 
-	// because of the last swap, the "from" area has the sorted payload: if it's
-	// not the original array "a", do a final copy
-	if (from != a) {
-		std::copy(from, from + count, a);
-	}
-}
\ No newline at end of file
+	// An odd number of passes leaves the sorted keys in the temporary
+	// buffer, and that goes away with the mark.
+	if (from != scratch.keys.data)
+		memcpy(scratch.keys.data, from, sizeof(render_sort_key_t) * count);
+	frame_scratch_release(mark);
+}
@@ -2,4 +2,4 @@
 
 #include "render.h"
 
-void radix_sort7(sk::render_item_t *a, size_t count);
\ No newline at end of file
+void radix_sort_keys(sk::render_sort_scratch_t &scratch);
@@ -1,4 +1,7 @@
 #include "system.h"
+#include "profiler.h"
+#include "frame_alloc.h"
+#include "memory_track.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -6,6 +9,9 @@
 #include "../libraries/stref.h"
 #include "../stereokit.h"
 
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
 #include <chrono>
 using namespace std::chrono;
 
@@ -18,14 +24,51 @@ struct sort_dependency_t {
 	int32_t  count;
 };
 
+// Per-frame state for scheduling system updates. Systems become ready
+// once all their update dependencies have finished, and thread safe ones
+// can be picked up by any thread.
+struct system_schedule_t {
+	std::mutex              lock;
+	std::condition_variable signal;
+
+	int32_t *remaining;
+	int32_t *ready_main;
+	int32_t  ready_main_count;
+	int32_t *ready_any;
+	int32_t  ready_any_count;
+	int32_t *submit;
+	int32_t  finished;
+	int64_t *path_start;
+
+	time_point<high_resolution_clock> frame_start;
+	int64_t  profile_critical_path;
+	int64_t  profile_frame_duration;
+	int64_t  profile_frame_count;
+
+	// The last few seconds of frame times, for percentiles. Systems each
+	// keep their own history in the same layout.
+	float    history[600];
+	float   *history_sorted;
+	float    budget_ms;
+	int64_t  over_budget;
+};
+
 system_t *systems           = nullptr;
 int32_t  *system_init_order = nullptr;
 int32_t   system_count = 0;
 int32_t   system_cap   = 0;
 
+system_schedule_t system_schedule;
+const int32_t     system_history_max = _countof(system_schedule_t::history);
+
 ///////////////////////////////////////////
 
 int32_t systems_find(const char *name);
+void    systems_schedule_init    ();
+void    systems_schedule_shutdown();
+void    systems_schedule_job     (void *data);
+void    systems_run_update       (int32_t index);
+frame_stats_t systems_history_stats(const float *history, int32_t frame_count);
 
 void    array_reorder(void **list, size_t item_size, int32_t count, int32_t *sort_order);
 int32_t topological_sort      (sort_dependency_t *dependencies, int32_t count, int32_t **out_order);
@@ -54,6 +97,28 @@ void systems_add(const char *name, const char **init_dependencies, int32_t init_
 
 ///////////////////////////////////////////
 
+void systems_set_threadsafe(const char *name) {
+	int32_t index = systems_find(name);
+	if (index == -1) {
+		log_errf("Can't find system by the name of %s!", name);
+		return;
+	}
+	systems[index].update_threadsafe = true;
+}
+
+///////////////////////////////////////////
+
+void systems_set_memory_tag(const char *name, memory_tag_ tag) {
+	int32_t index = systems_find(name);
+	if (index == -1) {
+		log_errf("Can't find system by the name of %s!", name);
+		return;
+	}
+	systems[index].memory_tag = tag;
+}
+
+///////////////////////////////////////////
+
 int32_t systems_find(const char *name) {
 	for (int32_t i = 0; i < system_count; i++) {
 		if (string_eq(name, systems[i].name))
@@ -138,6 +203,7 @@ bool systems_initialize() {
 			// start timing
 			time_point<high_resolution_clock> start = high_resolution_clock::now();
 
+			memory_scope(systems[index].memory_tag);
 			if (!systems[index].func_initialize()) {
 				log_errf("System %s failed to initialize!", systems[index].name);
 				return false;
@@ -148,38 +214,221 @@ bool systems_initialize() {
 			systems[index].profile_start_duration = duration_cast<nanoseconds>(end - start).count();
 		}
 	}
+	systems_schedule_init();
+
 	log_info("Initialization successful");
 	return true;
 }
 
 ///////////////////////////////////////////
 
+void systems_schedule_init() {
+	system_schedule_t &sched = system_schedule;
+
+	// Systems are in update order by now, so dependency names can be
+	// flipped around into a list of dependents for each system.
+	for (int32_t i = 0; i < system_count; i++) {
+		systems[i].update_dependents      = (int32_t*)malloc(sizeof(int32_t) * system_count);
+		systems[i].update_dependent_count = 0;
+		systems[i].profile_history        = (float*)calloc(system_history_max, sizeof(float));
+	}
+	for (int32_t i = 0; i < system_count; i++) {
+		for (int32_t d = 0; d < systems[i].update_dependency_count; d++) {
+			system_t &dependency = systems[systems_find(systems[i].update_dependencies[d])];
+			dependency.update_dependents[dependency.update_dependent_count++] = i;
+		}
+	}
+
+	sched.remaining  = (int32_t*)malloc(sizeof(int32_t) * system_count);
+	sched.ready_main = (int32_t*)malloc(sizeof(int32_t) * system_count);
+	sched.ready_any  = (int32_t*)malloc(sizeof(int32_t) * system_count);
+	sched.submit     = (int32_t*)malloc(sizeof(int32_t) * system_count);
+	sched.path_start = (int64_t*)malloc(sizeof(int64_t) * system_count);
+	sched.profile_critical_path  = 0;
+	sched.profile_frame_duration = 0;
+	sched.profile_frame_count    = 0;
+	sched.history_sorted         = (float*)malloc(sizeof(float) * system_history_max);
+	sched.over_budget            = 0;
+	if (sched.budget_ms <= 0)
+		sched.budget_ms = 1000 / 60.0f;
+}
+
+///////////////////////////////////////////
+
+void systems_schedule_shutdown() {
+	system_schedule_t &sched = system_schedule;
+	for (int32_t i = 0; i < system_count; i++) {
+		free(systems[i].update_dependents);
+		free(systems[i].profile_history);
+	}
+	free(sched.history_sorted);
+	sched.history_sorted = nullptr;
+	free(sched.remaining);
+	free(sched.ready_main);
+	free(sched.ready_any);
+	free(sched.submit);
+	free(sched.path_start);
+}
+
+///////////////////////////////////////////
+
+void systems_reset_history() {
+	system_schedule_t &sched = system_schedule;
+	sched.profile_critical_path  = 0;
+	sched.profile_frame_duration = 0;
+	sched.profile_frame_count    = 0;
+	sched.over_budget            = 0;
+	memset(sched.history, 0, sizeof(sched.history));
+	for (int32_t i = 0; i < system_count; i++) {
+		systems[i].profile_update_count    = 0;
+		systems[i].profile_update_duration = 0;
+		if (systems[i].profile_history != nullptr)
+			memset(systems[i].profile_history, 0, sizeof(float) * system_history_max);
+	}
+}
+
+///////////////////////////////////////////
+
+void systems_schedule_job(void *data) {
+	systems_run_update((int32_t)(intptr_t)data);
+}
+
+///////////////////////////////////////////
+
+void systems_run_update(int32_t index) {
+	system_schedule_t &sched  = system_schedule;
+	system_t          &system = systems[index];
+
+	if (system.func_update != nullptr) {
+		profile_zone(system.name);
+		memory_scope(system.memory_tag);
+
+		// start timing
+		time_point<high_resolution_clock> start = high_resolution_clock::now();
+
+		system.func_update();
+
+		// end timing
+		time_point<high_resolution_clock> end = high_resolution_clock::now();
+		system.profile_frame_start      = duration_cast<nanoseconds>(start - sched.frame_start).count();
+		system.profile_frame_duration   = duration_cast<nanoseconds>(end - start).count();
+		system.profile_update_duration += system.profile_frame_duration;
+		system.profile_update_count    += 1;
+	}
+
+	// Anything waiting only on this system is now ready to go
+	sched.lock.lock();
+	for (int32_t i = 0; i < system.update_dependent_count; i++) {
+		int32_t dependent = system.update_dependents[i];
+		sched.remaining[dependent] -= 1;
+		if (sched.remaining[dependent] == 0) {
+			if (systems[dependent].update_threadsafe) sched.ready_any [sched.ready_any_count++ ] = dependent;
+			else                                      sched.ready_main[sched.ready_main_count++] = dependent;
+		}
+	}
+	sched.finished += 1;
+	sched.lock.unlock();
+	sched.signal.notify_all();
+}
+
+///////////////////////////////////////////
+
 void systems_update() {
+	system_schedule_t &sched = system_schedule;
+	sched.frame_start = high_resolution_clock::now();
+	profiler_frame_begin();
+
+	// Queue up everything without dependencies
+	sched.lock.lock();
+	sched.finished         = 0;
+	sched.ready_main_count = 0;
+	sched.ready_any_count  = 0;
 	for (int32_t i = 0; i < system_count; i++) {
-		if (systems[i].func_update != nullptr) {
-			// start timing
-			time_point<high_resolution_clock> start = high_resolution_clock::now();
+		systems[i].profile_frame_duration = 0;
+		sched.remaining[i] = systems[i].update_dependency_count;
+		if (sched.remaining[i] == 0) {
+			if (systems[i].update_threadsafe) sched.ready_any [sched.ready_any_count++ ] = i;
+			else                              sched.ready_main[sched.ready_main_count++] = i;
+		}
+	}
+	sched.lock.unlock();
+	sched.signal.notify_all();
+
+	// The main thread runs the systems that need it, and hands thread safe
+	// ones off to the job system as they become ready. Main systems are
+	// picked in update order, to keep their order stable.
+	std::unique_lock<std::mutex> lock(sched.lock);
+	while (sched.finished < system_count) {
+		sched.signal.wait(lock, [&]{ return sched.ready_main_count > 0 || sched.ready_any_count > 0 || sched.finished == system_count; });
+
+		int32_t submit_count = sched.ready_any_count;
+		memcpy(sched.submit, sched.ready_any, sizeof(int32_t) * submit_count);
+		sched.ready_any_count = 0;
+
+		int32_t index = -1;
+		if (sched.ready_main_count > 0) {
+			int32_t first = 0;
+			for (int32_t i = 1; i < sched.ready_main_count; i++) {
+				if (sched.ready_main[i] < sched.ready_main[first])
+					first = i;
+			}
+			index = sched.ready_main[first];
+			sched.ready_main[first] = sched.ready_main[--sched.ready_main_count];
+		}
 
-			systems[i].func_update();
+		lock.unlock();
+		for (int32_t i = 0; i < submit_count; i++)
+			job_submit(systems_schedule_job, (void*)(intptr_t)sched.submit[i]);
+		if (index != -1)
+			systems_run_update(index);
+		lock.lock();
+	}
+	lock.unlock();
 
-			// end timing
-			time_point<high_resolution_clock> end = high_resolution_clock::now();
-			systems[i].profile_frame_duration   = duration_cast<nanoseconds>(end - start).count();
-			systems[i].profile_update_duration += systems[i].profile_frame_duration;
-			systems[i].profile_update_count    += 1;
+	// The critical path is the longest chain of dependent updates, the
+	// fastest this frame could have gone with unlimited threads.
+	int64_t critical_path = 0;
+	for (int32_t i = 0; i < system_count; i++)
+		sched.path_start[i] = 0;
+	for (int32_t i = 0; i < system_count; i++) {
+		int64_t path_end = sched.path_start[i] + systems[i].profile_frame_duration;
+		for (int32_t d = 0; d < systems[i].update_dependent_count; d++) {
+			int32_t dependent = systems[i].update_dependents[d];
+			if (sched.path_start[dependent] < path_end)
+				sched.path_start[dependent] = path_end;
 		}
+		if (critical_path < path_end)
+			critical_path = path_end;
 	}
+	int64_t frame_duration = duration_cast<nanoseconds>(high_resolution_clock::now() - sched.frame_start).count();
+	int32_t slot           = (int32_t)(sched.profile_frame_count % system_history_max);
+	float   frame_ms       = (float)(frame_duration / 1000000.0);
+	sched.history[slot] = frame_ms;
+	for (int32_t i = 0; i < system_count; i++)
+		systems[i].profile_history[slot] = (float)(systems[i].profile_frame_duration / 1000000.0);
+	if (frame_ms > sched.budget_ms)
+		sched.over_budget += 1;
+
+	sched.profile_critical_path  += critical_path;
+	sched.profile_frame_duration += frame_duration;
+	sched.profile_frame_count    += 1;
+	frame_alloc_end();
+	profiler_frame_end();
 }
 
 ///////////////////////////////////////////
 
 void systems_shutdown() {
+	frame_stats_t frame_stats = sk_frame_stats();
+	systems_schedule_shutdown();
+
 	for (int32_t i = system_count-1; i >= 0; i--) {
 		int32_t index = system_init_order[i];
 		if (systems[index].func_shutdown != nullptr) {
 			// start timing
 			time_point<high_resolution_clock> start = high_resolution_clock::now();
 
+			memory_scope(systems[index].memory_tag);
 			systems[index].func_shutdown();
 
 			// end timing
@@ -218,10 +467,130 @@ void systems_shutdown() {
 		log_infof("<~BLK>|<~CYN>%15s <~BLK>|<~clr> %s <~BLK>|<~clr> %s <~BLK>|<~clr> %s <~BLK>|<~clr>", systems[index].name, start_time, update_time, shutdown_time);
 	}
 	log_info("<~BLK>|________________|____________|__________|___________|<~clr>");
+	if (system_schedule.profile_frame_count > 0) {
+		double frames = (double)system_schedule.profile_frame_count;
+		log_infof("Update critical path: <~YLW>%.3f<~BLK>ms<~clr>, frame: <~YLW>%.3f<~BLK>ms<~clr>",
+			((double)system_schedule.profile_critical_path  / frames) / 1000000.0,
+			((double)system_schedule.profile_frame_duration / frames) / 1000000.0);
+		log_infof("Last %d frames p50: <~YLW>%.3f<~BLK>ms<~clr>, p99: <~YLW>%.3f<~BLK>ms<~clr>, max: <~YLW>%.3f<~BLK>ms<~clr>, %lld over the <~YLW>%.2f<~BLK>ms<~clr> budget",
+			frame_stats.frame_count, frame_stats.ms_p50, frame_stats.ms_p99, frame_stats.ms_max,
+			(long long)system_schedule.over_budget, system_schedule.budget_ms);
+		log_infof("Frame arena peak: <~YLW>%.1f<~BLK>KB<~clr>, scratch peak: <~YLW>%.1f<~BLK>KB<~clr>",
+			frame_stats.frame_mem_peak / 1024.0, frame_stats.scratch_mem_peak / 1024.0);
+	}
 
 	free(systems);
 	free(system_init_order);
 	systems = nullptr;
+	frame_alloc_shutdown();
+}
+
+///////////////////////////////////////////
+
+bool systems_write_report(const char *filename) {
+	FILE *fp = nullptr;
+	if (fopen_s(&fp, filename, "w") != 0 || fp == nullptr) {
+		log_errf("Couldn't write the performance report to %s!", filename);
+		return false;
+	}
+
+	// Same information as the shutdown report, but for machines to read
+	double        frames = system_schedule.profile_frame_count > 0 ? (double)system_schedule.profile_frame_count : 1;
+	frame_stats_t frame  = sk_frame_stats();
+	fprintf(fp, "{\n");
+	fprintf(fp, "\t\"frames\": %lld,\n",       (long long)system_schedule.profile_frame_count);
+	fprintf(fp, "\t\"budget_ms\": %.4f,\n",    system_schedule.budget_ms);
+	fprintf(fp, "\t\"over_budget\": %lld,\n",  (long long)system_schedule.over_budget);
+	fprintf(fp, "\t\"critical_path_ms\": %.4f,\n", ((double)system_schedule.profile_critical_path  / frames) / 1000000.0);
+	fprintf(fp, "\t\"frame\": { \"avg_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f },\n",
+		((double)system_schedule.profile_frame_duration / frames) / 1000000.0,
+		frame.ms_p50, frame.ms_p95, frame.ms_p99, frame.ms_max);
+	fprintf(fp, "\t\"memory\": { \"frame_peak_bytes\": %lld, \"scratch_peak_bytes\": %lld },\n",
+		(long long)frame.frame_mem_peak, (long long)frame.scratch_mem_peak);
+
+	render_stats_t render = render_get_stats();
+	fprintf(fp, "\t\"render\": { \"draw_calls\": %d, \"draw_instances\": %d, \"culled_frustum\": %d, \"culled_occlusion\": %d, \"cull_ms\": %.4f, \"occlusion_ms\": %.4f, \"sort_ms\": %.4f, \"instances_ms\": %.4f, \"submit_ms\": %.4f },\n",
+		render.draw_calls, render.draw_instances, render.culled_frustum, render.culled_occlusion,
+		render.ms_cull, render.ms_occlusion, render.ms_sort, render.ms_instances, render.ms_submit);
+
+	fprintf(fp, "\t\"systems\": [\n");
+	for (int32_t i = 0; i < system_count; i++) {
+		const system_t &system = systems[i];
+		frame_stats_t   stats  = systems_history_stats(system.profile_history, 0);
+		double          update = system.profile_update_count > 0
+			? ((double)system.profile_update_duration / system.profile_update_count) / 1000000.0
+			: 0;
+		fprintf(fp, "\t\t{ \"name\": \"%s\", \"init_ms\": %.4f, \"update_avg_ms\": %.4f, \"update_p50_ms\": %.4f, \"update_p95_ms\": %.4f, \"update_p99_ms\": %.4f, \"update_max_ms\": %.4f }%s\n",
+			system.name,
+			(double)system.profile_start_duration / 1000000.0,
+			update, stats.ms_p50, stats.ms_p95, stats.ms_p99, stats.ms_max,
+			i == system_count - 1 ? "" : ",");
+	}
+	fprintf(fp, "\t]\n}\n");
+	fclose(fp);
+	return true;
+}
+
+///////////////////////////////////////////
+
+frame_stats_t systems_history_stats(const float *history, int32_t frame_count) {
+	frame_stats_t result    = {};
+	int64_t       available = system_schedule.profile_frame_count < system_history_max
+		? system_schedule.profile_frame_count
+		: system_history_max;
+	if (frame_count <= 0 || frame_count > available)
+		frame_count = (int32_t)available;
+	if (frame_count == 0 || history == nullptr || system_schedule.history_sorted == nullptr)
+		return result;
+
+	// Walk back from the newest frame, and sort a copy for the percentiles
+	float  *sorted = system_schedule.history_sorted;
+	int64_t newest = system_schedule.profile_frame_count - 1;
+	for (int32_t i = 0; i < frame_count; i++) {
+		sorted[i] = history[(newest - i) % system_history_max];
+		if (sorted[i] > system_schedule.budget_ms)
+			result.over_budget += 1;
+	}
+	std::sort(sorted, sorted + frame_count);
+
+	result.frame_count = frame_count;
+	result.ms_p50 = sorted[(frame_count - 1) * 50 / 100];
+	result.ms_p95 = sorted[(frame_count - 1) * 95 / 100];
+	result.ms_p99 = sorted[(frame_count - 1) * 99 / 100];
+	result.ms_max = sorted[frame_count - 1];
+	return result;
+}
+
+///////////////////////////////////////////
+
+frame_stats_t sk_frame_stats(int32_t frame_count) {
+	frame_stats_t result = systems_history_stats(system_schedule.history, frame_count);
+	result.frame_mem_peak   = (int64_t)frame_alloc_peak  ();
+	result.scratch_mem_peak = (int64_t)frame_scratch_peak();
+	return result;
+}
+
+///////////////////////////////////////////
+
+frame_stats_t sk_system_frame_stats(const char *system_name, int32_t frame_count) {
+	int32_t index = systems_find(system_name);
+	if (index == -1) {
+		log_errf("sk_system_frame_stats: Can't find system by the name of %s!", system_name);
+		return {};
+	}
+	return systems_history_stats(systems[index].profile_history, frame_count);
+}
+
+///////////////////////////////////////////
+
+void sk_set_frame_budget(float budget_ms) {
+	system_schedule.budget_ms = budget_ms;
+}
+
+///////////////////////////////////////////
+
+int64_t sk_frames_over_budget() {
+	return system_schedule.over_budget;
 }
 
 ///////////////////////////////////////////
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../stereokit.h"
 #include <stdint.h>
 
 namespace sk {
@@ -11,8 +12,19 @@ struct system_t {
 	const char **update_dependencies;
 	int32_t      update_dependency_count;
 
+	// Thread safe systems can update on a worker thread, as soon as their
+	// update dependencies are done. Everything else updates on the main
+	// thread, but still in dependency order.
+	bool         update_threadsafe;
+	int32_t     *update_dependents;
+	int32_t      update_dependent_count;
+
+	// Allocations made while this system is running count against this
+	memory_tag_  memory_tag;
+
 	int64_t profile_frame_start;
 	int64_t profile_frame_duration;
+	float  *profile_history;
 
 	int64_t profile_update_count;
 	int64_t profile_update_duration;
@@ -25,9 +37,13 @@ struct system_t {
 };
 
 void    systems_add (const char *name, const char **init_dependencies, int32_t init_dependency_count, const char **update_dependencies, int32_t update_dependency_count, bool (*func_initialize)(void), void (*func_update)(void), void (*func_shutdown)(void));
+void    systems_set_threadsafe(const char *name);
+void    systems_set_memory_tag(const char *name, memory_tag_ tag);
 
 bool    systems_initialize();
 void    systems_update();
 void    systems_shutdown();
+bool    systems_write_report(const char *filename);
+void    systems_reset_history();
 
 } // namespace sk
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "../asset_types/material.h"
 #include "../asset_types/assets.h"
 #include "../systems/defaults.h"
+#include "../systems/profiler.h"
+#include "../systems/frame_alloc.h"
+#include "../systems/memory_track.h"
 #include "../hierarchy.h"
 #include "../math.h"
 #include "../libraries/array.h"
@@ -20,15 +23,21 @@ array_t<text_buffer_t> text_buffers = {};
 ///////////////////////////////////////////
 
 void text_buffer_ensure_capacity(text_buffer_t &buffer, size_t characters) {
+	// Vertices only live for the frame, but the capacity sticks around, so
+	// they start out at last frame's size.
+	if (buffer.verts == nullptr && buffer.vert_cap > 0)
+		buffer.verts = (vert_t *)frame_alloc(sizeof(vert_t) * buffer.vert_cap);
 	if (buffer.vert_count + characters * 4 <= buffer.vert_cap)
 		return;
 
+	int old_cap = buffer.vert_cap;
 	buffer.vert_cap = buffer.vert_count + (int)characters * 4;
-	buffer.verts    = (vert_t *)realloc(buffer.verts, sizeof(vert_t) * buffer.vert_cap);
+	buffer.verts    = (vert_t *)frame_realloc(buffer.verts, sizeof(vert_t) * old_cap, sizeof(vert_t) * buffer.vert_cap);
 
 	// regenerate indices
-	vind_t  quads = (vind_t)(buffer.vert_cap / 4);
-	vind_t *inds  = (vind_t *)malloc(quads * 6 * sizeof(vind_t));
+	frame_mark_t mark  = frame_scratch_mark();
+	vind_t       quads = (vind_t)(buffer.vert_cap / 4);
+	vind_t      *inds  = (vind_t *)frame_scratch_alloc(quads * 6 * sizeof(vind_t));
 	for (vind_t i = 0; i < quads; i++) {
 		vind_t q = i * 4;
 		vind_t c = i * 6;
@@ -41,12 +50,13 @@ void text_buffer_ensure_capacity(text_buffer_t &buffer, size_t characters) {
 		inds[c+5] = q;
 	}
 	mesh_set_inds(buffer.mesh, inds, quads * 6);
-	free(inds);
+	frame_scratch_release(mark);
 }
 
 ///////////////////////////////////////////
 
 text_style_t text_make_style(font_t font, float character_height, material_t material, color32 color) {
+	memory_scope(memory_tag_text);
 	uint32_t       id     = (uint32_t)(font->header.id << 16 | material->header.id);
 	size_t         index  = 0;
 	text_buffer_t *buffer = nullptr;
@@ -308,6 +318,7 @@ void text_add_at(const char* text, const matrix &transform, text_style_t style,
 
 void text_add_in(const char* text, const matrix& transform, vec2 size, text_fit_ fit, text_style_t style, text_align_ position, text_align_ align, float off_x, float off_y, float off_z) {
 	if (text == nullptr) return;
+	profile_zone("text_layout");
 
 	XMMATRIX tr;
 	if (hierarchy_enabled) {
@@ -392,10 +403,12 @@ void text_add_in(const char* text, const matrix& transform, vec2 size, text_fit_
 void text_update() {
 	for (size_t i = 0; i < text_buffers.count; i++) {
 		text_buffer_t &buffer = text_buffers[i];
+		vert_t        *verts  = buffer.verts;
+		buffer.verts = nullptr;
 		if (buffer.vert_count <= 0)
 			continue;
 
-		mesh_set_verts(buffer.mesh, buffer.verts, buffer.vert_count, false);
+		mesh_set_verts(buffer.mesh, verts, buffer.vert_count, false);
 		mesh_set_draw_inds(buffer.mesh, (buffer.vert_count / 4) * 6);
 
 		render_add_mesh(buffer.mesh, buffer.material, matrix_identity);
@@ -411,7 +424,6 @@ void text_shutdown() {
 		mesh_release(buffer.mesh);
 		font_release(buffer.font);
 		material_release(buffer.material);
-		free(buffer.verts);
 	}
 
 	text_styles .free();